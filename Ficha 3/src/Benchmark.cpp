@@ -0,0 +1,321 @@
+/*
+ * Benchmark.cpp
+ *
+ * Benchmark of the nearest points algorithms, built instead of the tests
+ * when BENCHMARK is defined (-DBENCHMARK).
+ *
+ * Usage: benchmark [options]
+ *   --algorithms DC,DC_MT,...  algorithms to run (see the table below)
+ *   --inputs Pontos128k,random:2097152,constx:2097152
+ *                              point files, or n random points with the
+ *                              generators of PointGenerator.h
+ *   --threads 1,2,4,8          thread counts for the multi-threaded algorithms
+ *   --warmup 1                 runs before measuring
+ *   --repetitions 5            measured runs
+ *   --seed 1                   seed of the random inputs
+ *   --csv file, --json file    also write the results to these files
+ *
+ * Each run gets a fresh copy of the input (not timed) and is timed with
+ * steady_clock in nanoseconds. Speedup is relative to the same algorithm
+ * with the first thread count of the list (efficiency = speedup per thread
+ * added from there), so a sweep starting at 1 gives the usual curves.
+ */
+
+#ifdef BENCHMARK
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "NearestPoints.h"
+#include "PointFile.h"
+#include "PointGenerator.h"
+
+struct Algorithm {
+	string name;
+	NP_FUNC func;
+	bool threaded; // uses setNumThreads
+};
+
+static const Algorithm algorithms[] = {
+	{ "BF", nearestPoints_BF, false },
+	{ "DC", nearestPoints_DC, false },
+	{ "DC_MT", nearestPoints_DC_MT, true },
+	{ "DC_Merge", nearestPoints_DC_Merge, false },
+	{ "DC_Merge_MT", nearestPoints_DC_Merge_MT, true },
+	{ "Grid", nearestPoints_Grid, false },
+	{ "StripY", nearestPoints_StripY, false },
+};
+
+struct Measurement {
+	string input;
+	int points;
+	string algorithm;
+	int threads;
+	int repetitions;
+	double minNs, medianNs, meanNs, stddevNs;
+	double speedup, efficiency;
+	double dmin;
+};
+
+static vector<string> split(const string &s)
+{
+	vector<string> parts;
+	stringstream ss(s);
+	string part;
+	while (getline(ss, part, ','))
+		if (!part.empty())
+			parts.push_back(part);
+	return parts;
+}
+
+/**
+ * Points of an input: "random:n", "constx:n" or a file name.
+ */
+static bool loadInput(const string &input, unsigned seed, vector<Point> &vp)
+{
+	size_t colon = input.find(':');
+	if (colon != string::npos)
+	{
+		string kind = input.substr(0, colon);
+		int n = atoi(input.c_str() + colon + 1);
+		if (n < 2)
+			return false;
+		if (kind == "random")
+			generateRandom(n, vp, seed);
+		else if (kind == "constx")
+			generateRandomConstX(n, vp, seed);
+		else
+			return false;
+		return true;
+	}
+	readPointsFile(input, vp);
+	return !vp.empty();
+}
+
+/**
+ * Runs func warmup + repetitions times on copies of the points.
+ * Returns false if the runs did not all find the same distance.
+ */
+static bool measure(const Algorithm &alg, const vector<Point> &points, int warmup, int repetitions,
+		Measurement &m)
+{
+	vector<double> times;
+	bool consistent = true;
+	for (int run = 0; run < warmup + repetitions; run++)
+	{
+		vector<Point> copy = points;
+		auto start = std::chrono::steady_clock::now();
+		Result res = alg.func(copy);
+		auto end = std::chrono::steady_clock::now();
+		if (run > 0 && res.dmin != m.dmin)
+			consistent = false;
+		m.dmin = res.dmin;
+		if (run >= warmup)
+			times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	}
+
+	std::sort(times.begin(), times.end());
+	int n = times.size();
+	double sum = 0, sum2 = 0;
+	for (double t : times)
+	{
+		sum += t;
+		sum2 += t * t;
+	}
+	m.repetitions = n;
+	m.minNs = times[0];
+	m.medianNs = (n % 2 == 1) ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+	m.meanNs = sum / n;
+	m.stddevNs = (n > 1) ? sqrt(std::max(0.0, (sum2 - sum * sum / n) / (n - 1))) : 0;
+	return consistent;
+}
+
+/**
+ * s as a CSV field (RFC 4180): in quotes, with inner quotes doubled, so
+ * commas and quotes in file names do not split it.
+ */
+static string csvField(const string &s)
+{
+	string out = "\"";
+	for (char ch : s)
+	{
+		if (ch == '"')
+			out += '"';
+		out += ch;
+	}
+	return out + "\"";
+}
+
+static void writeCSV(const string &fileName, const vector<Measurement> &results)
+{
+	ofstream os(fileName.c_str());
+	os.precision(17);
+	os << "input,points,algorithm,threads,repetitions,min_ns,median_ns,mean_ns,stddev_ns,speedup,efficiency,dmin\n";
+	for (auto &m : results)
+		os << csvField(m.input) << "," << m.points << "," << csvField(m.algorithm) << "," << m.threads << "," << m.repetitions << ","
+			<< m.minNs << "," << m.medianNs << "," << m.meanNs << "," << m.stddevNs << ","
+			<< m.speedup << "," << m.efficiency << "," << m.dmin << "\n";
+}
+
+/**
+ * s as the contents of a JSON string: quotes, backslashes (Windows paths)
+ * and control characters escaped.
+ */
+static string jsonEscape(const string &s)
+{
+	string out;
+	for (char ch : s)
+	{
+		if (ch == '"' || ch == '\\')
+		{
+			out += '\\';
+			out += ch;
+		}
+		else if ((unsigned char) ch < 0x20)
+		{
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", (unsigned char) ch);
+			out += code;
+		}
+		else
+			out += ch;
+	}
+	return out;
+}
+
+static void writeJSON(const string &fileName, const vector<Measurement> &results)
+{
+	ofstream os(fileName.c_str());
+	os.precision(17);
+	os << "[\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Measurement &m = results[i];
+		os << "  {\"input\": \"" << jsonEscape(m.input) << "\", \"points\": " << m.points
+			<< ", \"algorithm\": \"" << jsonEscape(m.algorithm) << "\", \"threads\": " << m.threads
+			<< ", \"repetitions\": " << m.repetitions
+			<< ", \"min_ns\": " << m.minNs << ", \"median_ns\": " << m.medianNs
+			<< ", \"mean_ns\": " << m.meanNs << ", \"stddev_ns\": " << m.stddevNs
+			<< ", \"speedup\": " << m.speedup << ", \"efficiency\": " << m.efficiency
+			<< ", \"dmin\": " << m.dmin << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	os << "]\n";
+}
+
+int main(int argc, char const *argv[]) {
+	vector<string> algorithmNames = split("DC,DC_MT,DC_Merge,DC_Merge_MT,Grid");
+	vector<string> inputs = split("Pontos128k,random:524288,random:2097152,constx:2097152");
+	vector<int> threadCounts = { 1, 2, 4, 8 };
+	int warmup = 1, repetitions = 5;
+	unsigned seed = DEFAULT_SEED;
+	string csvFile, jsonFile;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string option = argv[i];
+		if (i + 1 >= argc)
+		{
+			cerr << "Missing value for " << option << endl;
+			return EXIT_FAILURE;
+		}
+		string value = argv[++i];
+		if (option == "--algorithms")
+			algorithmNames = split(value);
+		else if (option == "--inputs")
+			inputs = split(value);
+		else if (option == "--threads")
+		{
+			threadCounts.clear();
+			for (auto &t : split(value))
+				threadCounts.push_back(std::max(1, atoi(t.c_str())));
+		}
+		else if (option == "--warmup")
+			warmup = std::max(0, atoi(value.c_str()));
+		else if (option == "--repetitions")
+			repetitions = std::max(1, atoi(value.c_str()));
+		else if (option == "--seed")
+			seed = strtoul(value.c_str(), nullptr, 10);
+		else if (option == "--csv")
+			csvFile = value;
+		else if (option == "--json")
+			jsonFile = value;
+		else
+		{
+			cerr << "Unknown option " << option << endl;
+			return EXIT_FAILURE;
+		}
+	}
+	if (threadCounts.empty())
+		threadCounts.push_back(1);
+
+	vector<const Algorithm *> selected;
+	for (auto &name : algorithmNames)
+	{
+		const Algorithm *found = nullptr;
+		for (auto &alg : algorithms)
+			if (alg.name == name)
+				found = &alg;
+		if (found == nullptr)
+		{
+			cerr << "Unknown algorithm " << name << endl;
+			return EXIT_FAILURE;
+		}
+		selected.push_back(found);
+	}
+
+	vector<Measurement> results;
+	bool consistent = true;
+	cout << "algorithm; data set; threads; median (ms); min (ms); speedup; efficiency; distance" << endl;
+	for (auto &input : inputs)
+	{
+		vector<Point> points;
+		if (!loadInput(input, seed, points))
+		{
+			cerr << "Cannot load input " << input << endl;
+			return EXIT_FAILURE;
+		}
+		for (auto alg : selected)
+		{
+			vector<int> threads = alg->threaded ? threadCounts : vector<int> { 1 };
+			double baseNs = 0;
+			for (size_t t = 0; t < threads.size(); t++)
+			{
+				Measurement m;
+				m.input = input;
+				m.points = points.size();
+				m.algorithm = alg->name;
+				m.threads = threads[t];
+				if (alg->threaded)
+					setNumThreads(threads[t]);
+				if (!measure(*alg, points, warmup, repetitions, m))
+				{
+					cerr << alg->name << " found different distances on " << input << endl;
+					consistent = false;
+				}
+				if (t == 0)
+					baseNs = m.medianNs;
+				m.speedup = baseNs / m.medianNs;
+				m.efficiency = m.speedup * threads[0] / threads[t];
+				results.push_back(m);
+				cout << m.algorithm << "; " << m.input << "; " << m.threads << "; "
+					<< m.medianNs / 1e6 << "; " << m.minNs / 1e6 << "; "
+					<< m.speedup << "; " << m.efficiency << "; " << m.dmin << endl;
+			}
+		}
+	}
+
+	if (!csvFile.empty())
+		writeCSV(csvFile, results);
+	if (!jsonFile.empty())
+		writeJSON(jsonFile, results);
+	return consistent ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif /* BENCHMARK */
@@ -0,0 +1,383 @@
+/*
+ * ClosestPair.h
+ */
+
+#ifndef CLOSESTPAIR_H_
+#define CLOSESTPAIR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include "NearestPoints.h"
+#include "PointSet.h"
+#include "WorkStealingPool.h"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Closest-pair algorithms templated over the point container C
+ * (PointArray or PointSoA<T>, see PointSet.h). Coordinates are read with
+ * c.x(i) / c.y(i) and all arithmetic is done in double.
+ */
+
+// Below this number of points the halves are solved sequentially
+const int PARALLEL_CUTOFF = 4096;
+
+#if defined(__AVX__)
+const int STRIP_LANES = 4;
+#elif defined(__SSE2__)
+const int STRIP_LANES = 2;
+#else
+const int STRIP_LANES = 1;
+#endif
+
+/**
+ * Compares point i with the candidates j, j+1, ... in blocks of
+ * STRIP_LANES (coordinates gathered into vectors), while they are within
+ * the best distance in Y. Returns false if it stopped because a candidate
+ * was too far in Y.
+ */
+template <class C>
+inline bool stripBlocks(const C &c, int n, int i, int &j, double &best2, int &bestI, int &bestJ)
+{
+	double xi = c.x(i), yi = c.y(i);
+#if defined(__AVX__)
+	__m256d vx = _mm256_set1_pd(xi), vy = _mm256_set1_pd(yi);
+	for ( ; j + 4 <= n; j += 4)
+	{
+		double dy0 = c.y(j) - yi;
+		if (dy0 * dy0 > best2)
+			return false;
+		__m256d dx = _mm256_sub_pd(_mm256_set_pd(c.x(j + 3), c.x(j + 2), c.x(j + 1), c.x(j)), vx);
+		__m256d dy = _mm256_sub_pd(_mm256_set_pd(c.y(j + 3), c.y(j + 2), c.y(j + 1), c.y(j)), vy);
+		__m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+		if (_mm256_movemask_pd(_mm256_cmp_pd(d2, _mm256_set1_pd(best2), _CMP_LT_OQ)) == 0)
+			continue;
+		double lanes[4];
+		_mm256_storeu_pd(lanes, d2);
+		for (int l = 0; l < 4; l++)
+			if (lanes[l] < best2)
+			{
+				best2 = lanes[l];
+				bestI = i;
+				bestJ = j + l;
+			}
+	}
+#elif defined(__SSE2__)
+	__m128d vx = _mm_set1_pd(xi), vy = _mm_set1_pd(yi);
+	for ( ; j + 2 <= n; j += 2)
+	{
+		double dy0 = c.y(j) - yi;
+		if (dy0 * dy0 > best2)
+			return false;
+		__m128d dx = _mm_sub_pd(_mm_set_pd(c.x(j + 1), c.x(j)), vx);
+		__m128d dy = _mm_sub_pd(_mm_set_pd(c.y(j + 1), c.y(j)), vy);
+		__m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+		if (_mm_movemask_pd(_mm_cmplt_pd(d2, _mm_set1_pd(best2))) == 0)
+			continue;
+		double lanes[2];
+		_mm_storeu_pd(lanes, d2);
+		for (int l = 0; l < 2; l++)
+			if (lanes[l] < best2)
+			{
+				best2 = lanes[l];
+				bestI = i;
+				bestJ = j + l;
+			}
+	}
+#endif
+	return true;
+}
+
+/**
+ * Nearest points in the strip c[left..right] (inclusive), sorted by Y;
+ * "res" contains initially the best solution found so far.
+ *
+ * Compares squared distances; sqrt is only taken for the final answer.
+ * Most points have one or two candidates within the best distance in Y,
+ * which are checked one by one; longer runs of candidates go through
+ * stripBlocks, several at a time.
+ */
+template <class C>
+void closestPairStrip(const C &c, int left, int right, Result &res)
+{
+	int n = right + 1;
+	double best2 = res.dmin * res.dmin; // inf while there is no solution
+	int bestI = -1, bestJ = -1;
+
+	for (int i = left; i < n - 1; i++)
+	{
+		double xi = c.x(i), yi = c.y(i);
+		int j = i + 1;
+		bool inside = true;
+		for (int end = std::min(n, j + STRIP_LANES); j < end; j++)
+		{
+			double dy = c.y(j) - yi;
+			if (dy * dy > best2)
+			{
+				inside = false;
+				break;
+			}
+			double dx = c.x(j) - xi;
+			if (dx * dx + dy * dy < best2)
+			{
+				best2 = dx * dx + dy * dy;
+				bestI = i;
+				bestJ = j;
+			}
+		}
+		if (inside)
+			inside = stripBlocks(c, n, i, j, best2, bestI, bestJ);
+		for ( ; inside && j < n; j++)
+		{
+			double dy = c.y(j) - yi;
+			if (dy * dy > best2)
+				break;
+			double dx = c.x(j) - xi;
+			if (dx * dx + dy * dy < best2)
+			{
+				best2 = dx * dx + dy * dy;
+				bestI = i;
+				bestJ = j;
+			}
+		}
+	}
+
+	if (bestI >= 0)
+		res = Result(sqrt(best2), c.point(bestI), c.point(bestJ));
+}
+
+template <class C>
+inline bool lessByY(const C &a, int i, const C &b, int j)
+{
+	return a.y(i) < b.y(j) || (a.y(i) == b.y(j) && a.x(i) < b.x(j));
+}
+
+/**
+ * Recursive divide and conquer algorithm that returns with c[left..right]
+ * sorted by Y: the halves come back sorted and are merged as in mergesort,
+ * so the strip is taken in Y order without sorting it.
+ * "aux" is a scratch container as large as c, shared by all levels
+ * (each call only uses aux[left..right]). The halves are tasks of "pool"
+ * (sequential if pool is null).
+ */
+template <class C>
+Result closestPairMerge(C &c, C &aux, int left, int right, WorkStealingPool *pool)
+{
+	Result best;
+
+	// Base case of a single point: no solution, so distance is MAX_DOUBLE
+	if (right <= left)
+		return best;
+
+	// Base case of two points
+	if (right - left == 1)
+	{
+		best = Result(c.point(left).distance(c.point(right)), c.point(left), c.point(right));
+		if (lessByY(c, right, c, left))
+			c.swap(left, right);
+		return best;
+	}
+
+	// The halves reorder their points, so keep the dividing line first
+	int center = (left + right) / 2;
+	double centerX = c.x(center);
+	Result dL, dR;
+	if (pool == nullptr || right - left < PARALLEL_CUTOFF)
+	{
+		dL = closestPairMerge(c, aux, left, center, pool);
+		dR = closestPairMerge(c, aux, center + 1, right, pool);
+	}
+	else
+	{
+		pool->invoke([&] { dL = closestPairMerge(c, aux, left, center, pool); },
+					 [&] { dR = closestPairMerge(c, aux, center + 1, right, pool); });
+	}
+	best = (dL.dmin < dR.dmin) ? dL : dR;
+
+	// Merge both halves by Y
+	int i = left, j = center + 1, k = left;
+	while (i <= center && j <= right)
+		aux.copy(k++, c, lessByY(c, j, c, i) ? j++ : i++);
+	while (i <= center)
+		aux.copy(k++, c, i++);
+	while (j <= right)
+		aux.copy(k++, c, j++);
+	for (k = left; k <= right; k++)
+		c.copy(k, aux, k);
+
+	// Strip area (already sorted by Y), copied to aux
+	int stripR = left;
+	for (k = left; k <= right; k++)
+		if (fabs(c.x(k) - centerX) <= best.dmin)
+			aux.copy(stripR++, c, k);
+
+	closestPairStrip(aux, left, stripR - 1, best);
+
+	return best;
+}
+
+/**
+ * Sorts c by X and runs closestPairMerge on all of it; c ends sorted by Y.
+ */
+template <class C>
+Result closestPairMerge(C &c, C &aux, WorkStealingPool *pool)
+{
+	c.sortByX(pool);
+	return closestPairMerge(c, aux, 0, c.size() - 1, pool);
+}
+
+/**
+ * Key of the grid cell (cx, cy). Distinct cells may share a key when the
+ * coordinates do not fit in 32 bits; that only adds candidates to check.
+ */
+inline uint64_t cellKey(int64_t cx, int64_t cy)
+{
+	return ((uint64_t)cx << 32) ^ (uint32_t)cy;
+}
+
+/**
+ * Hash table (open addressing, linear probing) from cell key to the first
+ * point of the cell; the other points of the cell are chained in "next".
+ */
+class CellTable {
+	vector<uint64_t> keys;
+	vector<int> heads;  // -1: empty slot
+	uint64_t mask;
+	int shift;
+
+	size_t slot(uint64_t key) const {
+		size_t i = (key * 0x9E3779B97F4A7C15ULL) >> shift;
+		while (heads[i] != -1 && keys[i] != key)
+			i = (i + 1) & mask;
+		return i;
+	}
+public:
+	explicit CellTable(int n) {
+		size_t capacity = 16;
+		shift = 60;
+		while (capacity < 2 * (size_t)n) {
+			capacity *= 2;
+			shift--;
+		}
+		keys.resize(capacity);
+		heads.assign(capacity, -1);
+		mask = capacity - 1;
+	}
+	void clear() {
+		std::fill(heads.begin(), heads.end(), -1);
+	}
+	int find(uint64_t key) const {
+		return heads[slot(key)];
+	}
+	// Makes k the first point of the cell; returns the previous first point (or -1)
+	int push(uint64_t key, int k) {
+		size_t i = slot(key);
+		int previous = heads[i];
+		keys[i] = key;
+		heads[i] = k;
+		return previous;
+	}
+};
+
+// Largest cell index (|coordinate| / side) of the grid: indices and their
+// neighbours must fit in int64_t
+const double MAX_CELL_INDEX = 4611686018427387904.0; // 2^62
+
+/**
+ * Randomized incremental algorithm (Rabin, Khuller-Matias), expected O(N).
+ * Points are inserted in random order into a hash grid whose cells have the
+ * side of the best distance so far, so only the 3x3 cells around a new point
+ * can hold a closer one. When a closer pair appears, the grid is rebuilt with
+ * the new distance; for a random order that happens O(log N) times, with
+ * expected linear total cost. The order comes from a fixed seed, so results
+ * and times are reproducible. If the distance gets so small next to the
+ * coordinates that the cell indices would not fit in int64_t, a copy of the
+ * points is solved by closestPairMerge instead.
+ */
+template <class C>
+Result closestPairGrid(const C &c)
+{
+	Result res;
+	int n = c.size();
+	if (n < 2)
+		return res;
+
+	vector<int> order(n);
+	for (int i = 0; i < n; i++)
+		order[i] = i;
+	std::mt19937 gen(12345);
+	std::shuffle(order.begin(), order.end(), gen);
+
+	res = Result(c.point(order[0]).distance(c.point(order[1])), c.point(order[0]), c.point(order[1]));
+	if (res.dmin == 0)
+		return res; // no grid of cells of side 0
+
+	double maxCoord = 0;
+	for (int i = 0; i < n; i++)
+		maxCoord = std::max(maxCoord, std::max(fabs(c.x(i)), fabs(c.y(i))));
+	auto tooFine = [&] { return maxCoord / res.dmin > MAX_CELL_INDEX; };
+	auto merge = [&] {
+		vector<Point> points(n), aux(n);
+		for (int i = 0; i < n; i++)
+			points[i] = c.point(i);
+		PointArray pa(points), pAux(aux);
+		return closestPairMerge(pa, pAux, nullptr);
+	};
+	if (tooFine())
+		return merge();
+
+	CellTable table(n);
+	vector<int> next(n, -1);  // next point in the same cell
+	double cell = res.dmin;
+
+	auto insert = [&](int k) {
+		int p = order[k];
+		next[k] = table.push(cellKey((int64_t)floor(c.x(p) / cell), (int64_t)floor(c.y(p) / cell)), k);
+	};
+	auto rebuild = [&](int count) {
+		table.clear();
+		cell = res.dmin;
+		for (int k = 0; k < count; k++)
+			insert(k);
+	};
+
+	rebuild(2);
+	for (int k = 2; k < n && res.dmin > 0; k++)
+	{
+		int p = order[k];
+		double px = c.x(p), py = c.y(p);
+		int64_t cx = (int64_t)floor(px / cell);
+		int64_t cy = (int64_t)floor(py / cell);
+		double best2 = res.dmin * res.dmin;
+		int closest = -1;
+		for (int64_t i = cx - 1; i <= cx + 1; i++)
+			for (int64_t j = cy - 1; j <= cy + 1; j++)
+				for (int q = table.find(cellKey(i, j)); q != -1; q = next[q])
+				{
+					double dx = c.x(order[q]) - px, dy = c.y(order[q]) - py;
+					if (dx * dx + dy * dy < best2)
+					{
+						best2 = dx * dx + dy * dy;
+						closest = order[q];
+					}
+				}
+
+		if (closest == -1)
+		{
+			insert(k);
+			continue;
+		}
+		res = Result(sqrt(best2), c.point(closest), c.point(p));
+		if (res.dmin > 0 && tooFine())
+			return merge();
+		if (res.dmin > 0)
+			rebuild(k + 1);
+	}
+	return res;
+}
+
+#endif /* CLOSESTPAIR_H_ */
@@ -0,0 +1,307 @@
+/*
+ * DynamicClosestPair.cpp
+ */
+
+#include "DynamicClosestPair.h"
+
+#include <cmath>
+#include <limits>
+#include "ClosestPair.h"
+
+static const double INF = std::numeric_limits<double>::infinity();
+
+// Smallest side of the cells, so that cell * cell / 16 is still a normal double
+static const double MIN_CELL = 1e-150;
+
+DynamicClosestPair::DynamicClosestPair() : count(0), cell(0), maxCoord(0)
+{
+}
+
+int DynamicClosestPair::size() const
+{
+	return count;
+}
+
+const Point &DynamicClosestPair::point(int id) const
+{
+	return pts[id];
+}
+
+uint64_t DynamicClosestPair::keyOf(const Point &p) const
+{
+	return cellKey((int64_t)floor(p.x / cell), (int64_t)floor(p.y / cell));
+}
+
+/**
+ * Calls f(q) for each point q in the 3x3 cells around p.
+ */
+template <class F>
+void DynamicClosestPair::forEachNear(const Point &p, F f) const
+{
+	int64_t cx = (int64_t)floor(p.x / cell);
+	int64_t cy = (int64_t)floor(p.y / cell);
+	for (int64_t i = cx - 1; i <= cx + 1; i++)
+		for (int64_t j = cy - 1; j <= cy + 1; j++)
+		{
+			auto it = cellHead.find(cellKey(i, j));
+			if (it == cellHead.end())
+				continue;
+			for (int q = it->second; q != -1; q = next[q])
+				f(q);
+		}
+}
+
+void DynamicClosestPair::link(int id)
+{
+	auto it = cellHead.insert(make_pair(keyOf(pts[id]), -1)).first;
+	int head = it->second;
+	next[id] = head;
+	prev[id] = -1;
+	if (head != -1)
+		prev[head] = id;
+	it->second = id;
+}
+
+void DynamicClosestPair::unlink(int id)
+{
+	if (prev[id] != -1)
+		next[prev[id]] = next[id];
+	else if (next[id] != -1)
+		cellHead[keyOf(pts[id])] = next[id];
+	else
+		cellHead.erase(keyOf(pts[id]));
+	if (next[id] != -1)
+		prev[next[id]] = prev[id];
+}
+
+/**
+ * Adds the nearest neighbour of id to the heap. Stale entries are dropped
+ * when the heap gets much larger than the set.
+ */
+void DynamicClosestPair::push(int id)
+{
+	if (heap.size() > 4 * (size_t) count + 1024)
+	{
+		priority_queue<Candidate> fresh;
+		while (!heap.empty())
+		{
+			if (valid(heap.top()))
+				fresh.push(heap.top());
+			heap.pop();
+		}
+		heap.swap(fresh);
+	}
+	heap.push(Candidate { nnDist2[id], id, nn[id] });
+}
+
+bool DynamicClosestPair::valid(const Candidate &c) const
+{
+	return alive[c.id] && nn[c.id] == c.nn && nnDist2[c.id] == c.d2;
+}
+
+/**
+ * Nearest neighbour of id among the points closer than cell.
+ */
+void DynamicClosestPair::findNearest(int id)
+{
+	const Point &p = pts[id];
+	double best2 = cell * cell;
+	int best = -1;
+	forEachNear(p, [&](int q) {
+		double d2 = p.distSquare(pts[q]);
+		if (d2 < best2 && q != id)
+		{
+			best2 = d2;
+			best = q;
+		}
+	});
+	nn[id] = best;
+	nnDist2[id] = (best == -1) ? INF : best2;
+	if (best != -1)
+		push(id);
+}
+
+/**
+ * Puts id in the grid: finds its nearest neighbour, and becomes the nearest
+ * neighbour of the points around that are closer to it than to theirs.
+ */
+void DynamicClosestPair::add(int id)
+{
+	link(id);
+	findNearest(id);
+	const Point &p = pts[id];
+	double cell2 = cell * cell;
+	forEachNear(p, [&](int q) {
+		double d2 = p.distSquare(pts[q]);
+		if (q != id && d2 < nnDist2[q] && d2 < cell2)
+		{
+			nn[q] = id;
+			nnDist2[q] = d2;
+			push(q);
+		}
+	});
+
+	// A new closest pair much shorter than the cells: smaller cells
+	if (nn[id] != -1 && nnDist2[id] > 0 && nnDist2[id] < cell2 / 16 && clampCell(2 * sqrt(nnDist2[id])) < cell)
+		rebuild(2 * sqrt(nnDist2[id]));
+}
+
+/**
+ * Puts the point id, just stored, in the grid. If it is so far out that
+ * its cell index would not fit in int64_t, the grid is rebuilt with larger
+ * cells instead.
+ */
+void DynamicClosestPair::place(int id)
+{
+	if (clampCell(cell) > cell)
+		rebuild(cell);
+	else
+		add(id);
+}
+
+/**
+ * Takes id out of the grid; the points that had it as nearest neighbour
+ * look for another one.
+ */
+void DynamicClosestPair::remove(int id)
+{
+	unlink(id);
+	nn[id] = -1;
+	nnDist2[id] = INF;
+	forEachNear(pts[id], [&](int q) {
+		if (nn[q] == id)
+			findNearest(q);
+	});
+}
+
+/**
+ * Side of the cells for the wanted side: at least MIN_CELL, and large enough
+ * that no cell index (or its neighbours) leaves the int64_t range.
+ */
+double DynamicClosestPair::clampCell(double side) const
+{
+	return max(side, max(maxCoord / MAX_CELL_INDEX, MIN_CELL));
+}
+
+void DynamicClosestPair::rebuild(double newCell)
+{
+	cell = clampCell(newCell);
+	cellHead.clear();
+	cellHead.reserve(count);
+	heap = priority_queue<Candidate>();
+	for (int id = 0; id < (int) pts.size(); id++)
+		if (alive[id])
+			link(id);
+	for (int id = 0; id < (int) pts.size(); id++)
+		if (alive[id])
+			findNearest(id);
+}
+
+/**
+ * Rebuilds the grid with cells twice the closest pair distance, found
+ * from scratch by the randomized grid algorithm. With coincident points
+ * (distance 0) the cells get the average spacing of the points instead.
+ */
+void DynamicClosestPair::rebuildExact()
+{
+	if (count < 2)
+	{
+		cell = 0;
+		cellHead.clear();
+		heap = priority_queue<Candidate>();
+		return;
+	}
+
+	vector<Point> v;
+	v.reserve(count);
+	double minX = INF, maxX = -INF, minY = INF, maxY = -INF;
+	for (int id = 0; id < (int) pts.size(); id++)
+		if (alive[id])
+		{
+			v.push_back(pts[id]);
+			minX = min(minX, pts[id].x);
+			maxX = max(maxX, pts[id].x);
+			minY = min(minY, pts[id].y);
+			maxY = max(maxY, pts[id].y);
+		}
+	double dmin = closestPairGrid(PointArray(v)).dmin;
+	if (dmin > 0)
+		rebuild(2 * dmin);
+	else
+	{
+		double spacing = max(maxX - minX, maxY - minY) / sqrt((double) count);
+		rebuild(spacing > 0 ? spacing : 1);
+	}
+}
+
+int DynamicClosestPair::insert(const Point &p)
+{
+	int id;
+	if (freeIds.empty())
+	{
+		id = pts.size();
+		pts.push_back(p);
+		alive.push_back(true);
+		next.push_back(-1);
+		prev.push_back(-1);
+		nn.push_back(-1);
+		nnDist2.push_back(INF);
+	}
+	else
+	{
+		id = freeIds.back();
+		freeIds.pop_back();
+		pts[id] = p;
+		alive[id] = true;
+	}
+	count++;
+	maxCoord = max(maxCoord, max(fabs(p.x), fabs(p.y)));
+
+	if (cell > 0)
+		place(id);
+	else if (count >= 2)
+		rebuildExact();
+	return id;
+}
+
+void DynamicClosestPair::erase(int id)
+{
+	if (id < 0 || id >= (int) pts.size() || !alive[id])
+		return;
+	if (cell > 0)
+		remove(id);
+	alive[id] = false;
+	count--;
+	freeIds.push_back(id);
+	if (count < 2)
+		rebuildExact();
+}
+
+void DynamicClosestPair::move(int id, const Point &p)
+{
+	if (id < 0 || id >= (int) pts.size() || !alive[id])
+		return;
+	if (cell > 0)
+		remove(id);
+	pts[id] = p;
+	maxCoord = max(maxCoord, max(fabs(p.x), fabs(p.y)));
+	if (cell > 0)
+		place(id);
+}
+
+Result DynamicClosestPair::closest()
+{
+	if (count < 2)
+		return Result();
+	for (;;)
+	{
+		while (!heap.empty() && !valid(heap.top()))
+			heap.pop();
+		if (!heap.empty())
+			break;
+		// No pair closer than cell: larger cells
+		rebuildExact();
+	}
+	const Candidate &c = heap.top();
+	return Result(sqrt(c.d2), pts[c.id], pts[c.nn]);
+}
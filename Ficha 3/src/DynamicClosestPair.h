@@ -0,0 +1,89 @@
+/*
+ * DynamicClosestPair.h
+ */
+
+#ifndef DYNAMICCLOSESTPAIR_H_
+#define DYNAMICCLOSESTPAIR_H_
+
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include "NearestPoints.h"
+#include "Point.h"
+
+/*
+ * Set of points under insertions and deletions that keeps its closest pair.
+ *
+ * Points are kept in a hash grid of square cells of side "cell", so any
+ * point closer than cell to p is in the 3x3 cells around p. Each point
+ * knows its nearest neighbour when it is closer than cell, and a heap of
+ * those distances gives the closest pair. An update only looks at the
+ * 3x3 cells around the point: the new point may become the nearest
+ * neighbour of points there, and a deleted point can only be the nearest
+ * neighbour of points there. Heap entries are not removed but checked when
+ * they reach the top.
+ *
+ * Updates take time proportional to the points in 3x3 cells plus a heap
+ * operation, O(log n). The grid is rebuilt (O(n) expected) when the closest
+ * pair becomes much shorter than cell, because the cells would hold too many
+ * points, or when no pair is closer than cell. For updates at random points
+ * that is rare, so updates take O(log n) expected amortized time.
+ * The side of the cells is kept large enough for the cell indices of every
+ * point to fit in int64_t, growing the cells when a point lands farther out.
+ *
+ * Points are identified by the id returned by insert (ids of erased points
+ * are reused).
+ */
+class DynamicClosestPair {
+public:
+	DynamicClosestPair();
+
+	int insert(const Point &p);
+	void erase(int id);
+	// Moves a point to p, keeping its id
+	void move(int id, const Point &p);
+	// Closest pair of the points (dmin is MAX_DOUBLE if there are fewer than 2)
+	Result closest();
+
+	int size() const;
+	const Point &point(int id) const;
+
+private:
+	struct Candidate {
+		double d2;
+		int id;
+		int nn;
+		bool operator<(const Candidate &c) const { return d2 > c.d2; } // min-heap
+	};
+
+	vector<Point> pts;
+	vector<char> alive;
+	vector<int> freeIds;
+	int count;
+
+	double cell;                              // side of the cells (0: no grid yet)
+	double maxCoord;                          // largest |x| or |y| seen
+	unordered_map<uint64_t, int> cellHead;    // first point of each cell
+	vector<int> next, prev;                   // points of the same cell
+	vector<int> nn;                           // nearest neighbour closer than cell, or -1
+	vector<double> nnDist2;
+	priority_queue<Candidate> heap;
+
+	uint64_t keyOf(const Point &p) const;
+	template <class F>
+	void forEachNear(const Point &p, F f) const;
+	void link(int id);
+	void unlink(int id);
+	void push(int id);
+	void findNearest(int id);
+	void add(int id);
+	void remove(int id);
+	double clampCell(double side) const;
+	void place(int id);
+	void rebuild(double newCell);
+	void rebuildExact();
+	bool valid(const Candidate &c) const;
+};
+
+#endif /* DYNAMICCLOSESTPAIR_H_ */
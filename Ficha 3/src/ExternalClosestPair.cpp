@@ -0,0 +1,341 @@
+/*
+ * ExternalClosestPair.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <string>
+#include "NearestPoints.h"
+#include "ClosestPair.h"
+#include "PointFile.h"
+
+/*
+ * Closest pair of a point file that does not fit in memory, keeping about
+ * chunkPoints points in memory at a time:
+ *  1. The file is read in chunks, each sorted by X and written to a
+ *     temporary run file.
+ *  2. The runs are merged into a file sorted by X. The merged points are
+ *     cut into slabs of chunkPoints consecutive points, each solved in
+ *     memory by closestPairMerge; the best of them gives dmin.
+ *  3. A pair closer than dmin must cross the boundary between two slabs, so
+ *     both points are within dmin in X of that boundary. These strips
+ *     (overlapping ones joined) are written to run files sorted by strip and
+ *     Y, merged, and swept in Y order keeping only the points less than dmin
+ *     below the current one. Inside a strip there is no pair closer than
+ *     dmin, so for a narrow strip this window holds a few points.
+ * Temporary files are named tempPrefix followed by a suffix. If one of them
+ * cannot be written or read, the result would come from part of the points,
+ * so the function fails instead.
+ */
+
+// Point of a strip, tagged with the strip it belongs to
+struct StripPoint {
+	int strip;
+	Point p;
+};
+
+struct LessByStripY {
+	bool operator()(const StripPoint &a, const StripPoint &b) const {
+		return a.strip < b.strip || (a.strip == b.strip && (a.p.y < b.p.y || (a.p.y == b.p.y && a.p.x < b.p.x)));
+	}
+};
+
+// Most runs merged at once (open files and buffers); more are merged in passes
+const int MERGE_FAN_IN = 64;
+
+/**
+ * Buffered writer of records to a binary file.
+ * ok() becomes false if the file could not be opened or written.
+ */
+template <class T>
+class RunWriter {
+	FILE *f;
+	vector<T> buf;
+	size_t capacity;
+	bool good;
+public:
+	RunWriter(const string &name, size_t capacity)
+		: f(fopen(name.c_str(), "wb")), capacity(std::max<size_t>(1, capacity)), good(f != nullptr) {
+		buf.reserve(this->capacity);
+	}
+	~RunWriter() { close(); }
+	bool ok() const { return good; }
+	void push(const T &t) {
+		buf.push_back(t);
+		if (buf.size() == capacity)
+			flush();
+	}
+	void flush() {
+		if (good && !buf.empty() && fwrite(buf.data(), sizeof(T), buf.size(), f) != buf.size())
+			good = false;
+		buf.clear();
+	}
+	// Returns ok(), now that everything is written
+	bool close() {
+		flush();
+		if (f != nullptr && fclose(f) != 0)
+			good = false;
+		f = nullptr;
+		return good;
+	}
+};
+
+/**
+ * Buffered reader of records from a binary file.
+ * ok() is false if the file could not be opened or read (the end of the
+ * file is not an error).
+ */
+template <class T>
+class RunReader {
+	FILE *f;
+	vector<T> buf;
+	size_t pos;
+	size_t capacity;
+	bool good;
+public:
+	RunReader(const string &name, size_t capacity)
+		: f(fopen(name.c_str(), "rb")), pos(0), capacity(std::max<size_t>(1, capacity)), good(f != nullptr) {}
+	~RunReader() {
+		if (f != nullptr)
+			fclose(f);
+	}
+	bool ok() const { return good; }
+	bool next(T &t) {
+		if (pos == buf.size())
+		{
+			if (!good)
+				return false;
+			buf.resize(capacity);
+			size_t n = fread(buf.data(), sizeof(T), capacity, f);
+			if (n < capacity && ferror(f))
+				good = false;
+			buf.resize(n);
+			pos = 0;
+			if (n == 0)
+				return false;
+		}
+		t = buf[pos++];
+		return true;
+	}
+};
+
+static void removeRuns(vector<string> &runs)
+{
+	for (auto &name : runs)
+		std::remove(name.c_str());
+	runs.clear();
+}
+
+/**
+ * Sorts "records" and writes them to a new run file, whose name is added
+ * to "runs". Returns false if the file could not be written.
+ */
+template <class T, class Less>
+static bool writeRun(vector<T> &records, Less less, const string &prefix, int &runCount, vector<string> &runs)
+{
+	std::sort(records.begin(), records.end(), less);
+	string name = prefix + ".run" + to_string(runCount++);
+	runs.push_back(name);
+	FILE *f = fopen(name.c_str(), "wb");
+	bool ok = f != nullptr && fwrite(records.data(), sizeof(T), records.size(), f) == records.size();
+	if (f != nullptr && fclose(f) != 0)
+		ok = false;
+	records.clear();
+	return ok;
+}
+
+/**
+ * Merges up to MERGE_FAN_IN sorted runs (k-way, with a heap of the first
+ * record of each), calling emit for each record in order.
+ * The buffers of the runs together hold about bufferRecords records.
+ * Returns false if a run could not be read.
+ */
+template <class T, class Less, class Emit>
+static bool mergeGroup(const vector<string> &runs, Less less, size_t bufferRecords, Emit emit)
+{
+	size_t perRun = std::max<size_t>(1, bufferRecords / std::max<size_t>(1, runs.size()));
+	vector<std::unique_ptr<RunReader<T>>> readers;
+	for (auto &name : runs)
+	{
+		readers.emplace_back(new RunReader<T>(name, perRun));
+		if (!readers.back()->ok())
+			return false;
+	}
+
+	typedef std::pair<T, int> Head;
+	auto greater = [&](const Head &a, const Head &b) { return less(b.first, a.first); };
+	std::priority_queue<Head, vector<Head>, decltype(greater)> heads(greater);
+	T t;
+	for (int r = 0; r < (int) readers.size(); r++)
+		if (readers[r]->next(t))
+			heads.push(Head(t, r));
+	while (!heads.empty())
+	{
+		Head h = heads.top();
+		heads.pop();
+		emit(h.first);
+		if (readers[h.second]->next(t))
+			heads.push(Head(t, h.second));
+	}
+
+	for (auto &reader : readers)
+		if (!reader->ok())
+			return false;
+	return true;
+}
+
+/**
+ * Merges the sorted runs, calling emit for each record in order, and removes
+ * the run files. While there are more than MERGE_FAN_IN runs, groups of them
+ * are merged into longer runs first, so at most MERGE_FAN_IN files are open
+ * and about bufferRecords records are buffered.
+ * Returns false if a run could not be read or written.
+ */
+template <class T, class Less, class Emit>
+static bool mergeRuns(vector<string> &runs, Less less, size_t bufferRecords, const string &prefix,
+		int &runCount, Emit emit)
+{
+	bool ok = true;
+	while (ok && runs.size() > (size_t) MERGE_FAN_IN)
+	{
+		vector<string> merged;
+		for (size_t first = 0; ok && first < runs.size(); first += MERGE_FAN_IN)
+		{
+			vector<string> group(runs.begin() + first, runs.begin() + std::min(runs.size(), first + MERGE_FAN_IN));
+			string name = prefix + ".run" + to_string(runCount++);
+			merged.push_back(name);
+			RunWriter<T> writer(name, bufferRecords / 2);
+			ok = writer.ok()
+				&& mergeGroup<T>(group, less, bufferRecords / 2, [&](const T &t) { writer.push(t); })
+				&& writer.close();
+			removeRuns(group);
+		}
+		removeRuns(runs);
+		runs = merged;
+	}
+	ok = ok && mergeGroup<T>(runs, less, bufferRecords, emit);
+	removeRuns(runs);
+	return ok;
+}
+
+bool nearestPoints_External(const string &fileName, int chunkPoints, const string &tempPrefix, Result &res)
+{
+	Result best;
+	if (chunkPoints < 2)
+		chunkPoints = 2;
+	PointReader reader(fileName);
+	if (!reader.isOpen())
+		return false;
+
+	// 1. Runs sorted by X
+	vector<string> runs;
+	int runCount = 0;
+	bool ok = true;
+	vector<Point> chunk;
+	chunk.reserve(chunkPoints);
+	while (ok && reader.read(chunk, chunkPoints) > 0)
+		ok = writeRun(chunk, LessByX(), tempPrefix, runCount, runs);
+	if (!ok)
+	{
+		removeRuns(runs);
+		return false;
+	}
+
+	// 2. Merge by X, solving each slab of chunkPoints points
+	string sortedName = tempPrefix + ".sorted";
+	vector<double> bounds; // X of the first point of each slab but the first
+	vector<Point> aux(chunkPoints);
+	auto solveSlab = [&] {
+		PointArray slab(chunk), slabAux(aux);
+		Result r = closestPairMerge(slab, slabAux, 0, chunk.size() - 1, nullptr);
+		if (r.dmin < best.dmin)
+			best = r;
+		chunk.clear();
+	};
+	{
+		RunWriter<Point> sorted(sortedName, 1 << 16);
+		ok = sorted.ok()
+			&& mergeRuns<Point>(runs, LessByX(), chunkPoints, tempPrefix, runCount, [&](const Point &p) {
+				if (chunk.size() == (size_t) chunkPoints)
+				{
+					solveSlab();
+					bounds.push_back(p.x);
+				}
+				chunk.push_back(p);
+				sorted.push(p);
+			})
+			&& sorted.close();
+	}
+	removeRuns(runs);
+	if (!chunk.empty())
+		solveSlab();
+
+	// 3. Strips around the bounds, [b - dmin, b + dmin], joined when they overlap
+	if (ok && !bounds.empty() && best.dmin > 0)
+	{
+		double d = best.dmin;
+		vector<double> stripL, stripR;
+		for (double b : bounds)
+		{
+			if (!stripR.empty() && b - d <= stripR.back())
+				stripR.back() = b + d;
+			else
+			{
+				stripL.push_back(b - d);
+				stripR.push_back(b + d);
+			}
+		}
+
+		vector<StripPoint> records;
+		records.reserve(chunkPoints);
+		{
+			RunReader<Point> sorted(sortedName, 1 << 16);
+			Point p;
+			size_t s = 0;
+			while (ok && sorted.next(p))
+			{
+				while (s < stripR.size() && p.x > stripR[s])
+					s++;
+				if (s == stripR.size())
+					break;
+				if (p.x < stripL[s])
+					continue;
+				records.push_back(StripPoint { (int) s, p });
+				if (records.size() == (size_t) chunkPoints)
+					ok = writeRun(records, LessByStripY(), tempPrefix, runCount, runs);
+			}
+			ok = ok && sorted.ok();
+		}
+		if (ok && !records.empty())
+			ok = writeRun(records, LessByStripY(), tempPrefix, runCount, runs);
+		records.shrink_to_fit();
+
+		// Sweep by Y: the window keeps the points of the strip less than dmin below
+		std::deque<StripPoint> window;
+		ok = ok && mergeRuns<StripPoint>(runs, LessByStripY(), chunkPoints, tempPrefix, runCount,
+				[&](const StripPoint &sp) {
+			while (!window.empty() && (window.front().strip != sp.strip || sp.p.y - window.front().p.y >= best.dmin))
+				window.pop_front();
+			for (auto &w : window)
+			{
+				double dx = w.p.x - sp.p.x;
+				if (fabs(dx) >= best.dmin)
+					continue;
+				double dist = w.p.distance(sp.p);
+				if (dist < best.dmin)
+					best = Result(dist, w.p, sp.p);
+			}
+			window.push_back(sp);
+		});
+		removeRuns(runs);
+	}
+	std::remove(sortedName.c_str());
+
+	if (ok)
+		res = best;
+	return ok;
+}
@@ -0,0 +1,164 @@
+/*
+ * KdTree.cpp
+ */
+
+#include "KdTree.h"
+
+#include <algorithm>
+#include <limits>
+
+// Ranges up to this size are not split, but scanned
+static const int LEAF_SIZE = 8;
+
+// Point with its original index, while building
+struct Entry {
+	Point p;
+	int index;
+};
+
+/**
+ * Places the middle entry of [l, r) by the coordinate of this depth, with the
+ * entries not greater before it and the entries not smaller after it.
+ * It stays there as the node; the subtrees are [l, m) and [m + 1, r).
+ */
+static void build(vector<Entry> &e, int l, int r, int depth)
+{
+	if (r - l <= LEAF_SIZE)
+		return;
+	int m = (l + r) / 2;
+	if (depth % 2 == 0)
+		std::nth_element(e.begin() + l, e.begin() + m, e.begin() + r,
+				[](const Entry &a, const Entry &b) { return a.p.x < b.p.x; });
+	else
+		std::nth_element(e.begin() + l, e.begin() + m, e.begin() + r,
+				[](const Entry &a, const Entry &b) { return a.p.y < b.p.y; });
+	build(e, l, m, depth + 1);
+	build(e, m + 1, r, depth + 1);
+}
+
+KdTree::KdTree(const vector<Point> &vp) : pts(vp.size()), idx(vp.size())
+{
+	vector<Entry> e(vp.size());
+	for (int i = 0; i < (int) vp.size(); i++)
+		e[i] = { vp[i], i };
+	build(e, 0, e.size(), 0);
+	for (int i = 0; i < (int) e.size(); i++)
+	{
+		pts[i] = e[i].p;
+		idx[i] = e[i].index;
+	}
+}
+
+int KdTree::size() const
+{
+	return pts.size();
+}
+
+int KdTree::index(int pos) const
+{
+	return idx[pos];
+}
+
+const Point &KdTree::point(int pos) const
+{
+	return pts[pos];
+}
+
+int KdTree::nearest(const Point &q, int self) const
+{
+	double best2 = std::numeric_limits<double>::max();
+	int best = -1;
+	searchNearest(0, pts.size(), 0, q, self, best2, best);
+	return best;
+}
+
+/**
+ * Visits first the half of q, and then the other one if it may hold a
+ * point closer than the best so far.
+ */
+void KdTree::searchNearest(int l, int r, int depth, const Point &q, int self, double &best2, int &best) const
+{
+	if (r - l <= LEAF_SIZE)
+	{
+		for (int i = l; i < r; i++)
+		{
+			double d2 = q.distSquare(pts[i]);
+			if (d2 < best2 && i != self)
+			{
+				best2 = d2;
+				best = i;
+			}
+		}
+		return;
+	}
+	int m = (l + r) / 2;
+	double d2 = q.distSquare(pts[m]);
+	if (d2 < best2 && m != self)
+	{
+		best2 = d2;
+		best = m;
+	}
+	double diff = (depth % 2 == 0) ? q.x - pts[m].x : q.y - pts[m].y;
+	if (diff < 0)
+	{
+		searchNearest(l, m, depth + 1, q, self, best2, best);
+		if (diff * diff < best2)
+			searchNearest(m + 1, r, depth + 1, q, self, best2, best);
+	}
+	else
+	{
+		searchNearest(m + 1, r, depth + 1, q, self, best2, best);
+		if (diff * diff < best2)
+			searchNearest(l, m, depth + 1, q, self, best2, best);
+	}
+}
+
+void KdTree::nearest(const Point &q, int k, int minIndex, double limit2,
+		vector<pair<double, int>> &out) const
+{
+	out.clear();
+	if (k <= 0)
+		return;
+	searchK(0, pts.size(), 0, q, k, minIndex, limit2, out);
+}
+
+/**
+ * Same search keeping the k nearest in "out", sorted by distance; once there
+ * are k, limit2 is the distance of the last one.
+ */
+void KdTree::searchK(int l, int r, int depth, const Point &q, int k, int minIndex, double &limit2,
+		vector<pair<double, int>> &out) const
+{
+	auto consider = [&](int i) {
+		double d2 = q.distSquare(pts[i]);
+		if (d2 >= limit2 || idx[i] <= minIndex)
+			return;
+		pair<double, int> found(d2, idx[i]);
+		if ((int) out.size() == k)
+			out.pop_back();
+		out.insert(std::upper_bound(out.begin(), out.end(), found), found);
+		if ((int) out.size() == k)
+			limit2 = out.back().first;
+	};
+	if (r - l <= LEAF_SIZE)
+	{
+		for (int i = l; i < r; i++)
+			consider(i);
+		return;
+	}
+	int m = (l + r) / 2;
+	consider(m);
+	double diff = (depth % 2 == 0) ? q.x - pts[m].x : q.y - pts[m].y;
+	if (diff < 0)
+	{
+		searchK(l, m, depth + 1, q, k, minIndex, limit2, out);
+		if (diff * diff < limit2)
+			searchK(m + 1, r, depth + 1, q, k, minIndex, limit2, out);
+	}
+	else
+	{
+		searchK(m + 1, r, depth + 1, q, k, minIndex, limit2, out);
+		if (diff * diff < limit2)
+			searchK(l, m, depth + 1, q, k, minIndex, limit2, out);
+	}
+}
@@ -0,0 +1,45 @@
+/*
+ * KdTree.h
+ */
+
+#ifndef KDTREE_H_
+#define KDTREE_H_
+
+#include <utility>
+#include <vector>
+#include "Point.h"
+
+/*
+ * Static 2-d tree over a copy of the points. The tree is implicit: the points
+ * are reordered so that each node is a range [l, r) whose middle point splits
+ * the rest, by X at even depths and by Y at odd depths (nth_element, so
+ * building takes O(n log n)). Queries refer to points by position in that
+ * order; index(pos) gives the original index.
+ */
+class KdTree {
+public:
+	explicit KdTree(const vector<Point> &vp);
+
+	int size() const;
+	int index(int pos) const;
+	const Point &point(int pos) const;
+
+	// Position of the nearest point to q other than the one at position self (-1 if none)
+	int nearest(const Point &q, int self) const;
+
+	// The k nearest points to q with original index greater than minIndex and
+	// squared distance below limit2, as (squared distance, original index),
+	// from the nearest
+	void nearest(const Point &q, int k, int minIndex, double limit2,
+			vector<pair<double, int>> &out) const;
+
+private:
+	vector<Point> pts;
+	vector<int> idx;
+
+	void searchNearest(int l, int r, int depth, const Point &q, int self, double &best2, int &best) const;
+	void searchK(int l, int r, int depth, const Point &q, int k, int minIndex, double &limit2,
+			vector<pair<double, int>> &out) const;
+};
+
+#endif /* KDTREE_H_ */
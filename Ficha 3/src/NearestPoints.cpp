@@ -4,12 +4,13 @@
 
 #include <limits>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <memory>
 #include "NearestPoints.h"
 #include "Point.h"
-
-#define _WIN32_WINNT 0x0501
-#include "mingw.thread.h"
+#include "ClosestPair.h"
+#include "KdTree.h"
 
 const double MAX_DOUBLE = std::numeric_limits<double>::max();
 
@@ -30,14 +31,13 @@ Result::Result() {
  */
 static void sortByX(vector<Point> &v, int left, int right)
 {
-	std::sort(v.begin( ) + left, v.begin() + right + 1,
-		[](Point p, Point q){ return p.x < q.x || (p.x == q.x && p.y < q.y); });
+	std::sort(v.begin( ) + left, v.begin() + right + 1, LessByX());
 }
 
 static void sortByY(vector<Point> &v, int left, int right)
 {
 	std::sort(v.begin( ) + left, v.begin() + right + 1,
-		[](Point p, Point q){ return p.y < q.y || (p.y == q.y && p.x < q.x); });
+		[](const Point &p, const Point &q){ return p.y < q.y || (p.y == q.y && p.x < q.x); });
 }
 
 /**
@@ -85,32 +85,16 @@ Result nearestPoints_BF_SortByX(vector<Point> &vp) {
  */
 static void npByY(vector<Point> &vp, int left, int right, Result &res)
 {
-	Point pI, pJ;
-	double dst;
-	for (int i = left; i < right; i++)
-	{
-		pI = vp[i];
-		for (int j = i + 1; j < right; j++)
-		{
-			pJ = vp[j];
-			if (fabs(pI.y - pJ.y) > res.dmin)
-				break;
-			else if ( (dst = pI.distance(pJ)) < res.dmin)
-			{
-				res.p1 = pI;
-				res.p2 = pJ;
-				res.dmin = dst;
-			}
-		}
-	}
+	closestPairStrip(PointArray(vp), left, right, res);
 }
 
 /**
  * Recursive divide and conquer algorithm.
  * Finds the nearest points in "vp" between indices left and right (inclusive),
- * using at most numThreads.
+ * solving the halves as tasks of "pool" (sequentially if pool is null).
+ * Both halves work on disjoint ranges of the same vector.
  */
-static Result np_DC(vector<Point> &vp, int left, int right, int numThreads)
+static Result np_DC(vector<Point> &vp, int left, int right, WorkStealingPool *pool)
 {
 	Result best;
 
@@ -128,24 +112,19 @@ static Result np_DC(vector<Point> &vp, int left, int right, int numThreads)
 		return best;
 
 	// Divide in halves (left and right) and solve them recursively,
-	// possibly in parallel (in case numThreads > 1)
+	// possibly in parallel (above the cutoff, when there is a pool)
 	int center;
 	Result dL, dR;
 	center = (left + right) / 2;
-	if (numThreads < 2)
+	if (pool == nullptr || right - left < PARALLEL_CUTOFF)
 	{
-		dL = np_DC(vp, left, center, numThreads);
-		dR = np_DC(vp, center + 1, right, numThreads);
+		dL = np_DC(vp, left, center, pool);
+		dR = np_DC(vp, center + 1, right, pool);
 	}
 	else
 	{
-
-		//std::thread t;
-
-		std::thread t_np_DC { np_DC, vp, left, center, numThreads / 2 };
-		dR = np_DC(vp, center + 1, right, numThreads / 2);
-
-		 t_np_DC.join();
+		pool->invoke([&] { dL = np_DC(vp, left, center, pool); },
+					 [&] { dR = np_DC(vp, center + 1, right, pool); });
 	}
 
 	// Select the best solution from left and right
@@ -192,20 +171,220 @@ void setNumThreads(int num)
 	numThreads = num;
 }
 
+/**
+ * Pool with numThreads threads, kept between calls.
+ */
+static WorkStealingPool *threadPool()
+{
+	static std::unique_ptr<WorkStealingPool> pool;
+	if (!pool || pool->size() != numThreads)
+		pool.reset(new WorkStealingPool(numThreads));
+	return pool.get();
+}
+
 /*
  * Divide and conquer approach, single-threaded version.
  */
 Result nearestPoints_DC(vector<Point> &vp) {
-	sortByX(vp, 0, vp.size() -1);
-	return np_DC(vp, 0, vp.size() - 1, 1);
+	parallelSort(vp, LessByX(), nullptr);
+	return np_DC(vp, 0, vp.size() - 1, nullptr);
 }
 
 
 /*
  * Multi-threaded version, using the number of threads specified
- * by setNumThreads().
+ * by setNumThreads(), both for the initial sort and the recursion.
  */
 Result nearestPoints_DC_MT(vector<Point> &vp) {
-	sortByX(vp, 0, vp.size() -1);
-	return np_DC(vp, 0, vp.size() - 1, numThreads);
+	WorkStealingPool *pool = threadPool();
+	parallelSort(vp, LessByX(), pool);
+	return np_DC(vp, 0, vp.size() - 1, pool);
+}
+
+/*
+ * Divide and conquer keeping the points sorted by Y through the recursion,
+ * O(n log n). Leaves vp sorted by Y.
+ */
+Result nearestPoints_DC_Merge(vector<Point> &vp) {
+	vector<Point> auxPoints(vp.size());
+	PointArray points(vp), aux(auxPoints);
+	return closestPairMerge(points, aux, nullptr);
+}
+
+/*
+ * Same, with the threads specified by setNumThreads().
+ */
+Result nearestPoints_DC_Merge_MT(vector<Point> &vp) {
+	vector<Point> auxPoints(vp.size());
+	PointArray points(vp), aux(auxPoints);
+	return closestPairMerge(points, aux, threadPool());
+}
+
+/*
+ * The same on points stored as separate x and y arrays.
+ */
+template <class T>
+Result nearestPoints_DC_Merge(PointSoA<T> &pts) {
+	PointSoA<T> aux(pts.size());
+	return closestPairMerge(pts, aux, nullptr);
+}
+
+template <class T>
+Result nearestPoints_DC_Merge_MT(PointSoA<T> &pts) {
+	PointSoA<T> aux(pts.size());
+	return closestPairMerge(pts, aux, threadPool());
+}
+
+template Result nearestPoints_DC_Merge(PointSoA<double> &pts);
+template Result nearestPoints_DC_Merge(PointSoA<float> &pts);
+template Result nearestPoints_DC_Merge_MT(PointSoA<double> &pts);
+template Result nearestPoints_DC_Merge_MT(PointSoA<float> &pts);
+
+/*
+ * Strip scan alone: sorts by Y and runs npByY over the whole vector.
+ * When all points share the same X (the ConstX data sets) this is what the
+ * divide and conquer ends up doing at the top level.
+ */
+Result nearestPoints_StripY(vector<Point> &vp) {
+	Result res;
+	sortByY(vp, 0, vp.size() - 1);
+	npByY(vp, 0, vp.size() - 1, res);
+	return res;
+}
+
+/**
+ * Randomized incremental algorithm with a hash grid, expected O(N)
+ * (see closestPairGrid).
+ */
+Result nearestPoints_Grid(vector<Point> &vp) {
+	return closestPairGrid(PointArray(vp));
+}
+
+template <class T>
+Result nearestPoints_Grid(PointSoA<T> &pts) {
+	return closestPairGrid(pts);
+}
+
+template Result nearestPoints_Grid(PointSoA<double> &pts);
+template Result nearestPoints_Grid(PointSoA<float> &pts);
+
+// Queries per task of the k-d tree algorithms
+const int QUERY_BLOCK = 4096;
+
+/**
+ * Number of blocks of queries: a single one without a pool.
+ */
+static int blockCount(int n, WorkStealingPool *pool)
+{
+	return (pool == nullptr) ? 1 : std::max(1, (n + QUERY_BLOCK - 1) / QUERY_BLOCK);
+}
+
+/**
+ * Runs solve(b, begin, end) for each block b of [0, n), as tasks of "pool".
+ */
+template <class F>
+static void forEachBlock(int n, WorkStealingPool *pool, F solve)
+{
+	if (pool == nullptr)
+		solve(0, 0, n);
+	else
+		pool->parallelFor(0, blockCount(n, pool), [&](int b) {
+			solve(b, b * QUERY_BLOCK, std::min(n, (b + 1) * QUERY_BLOCK));
+		});
+}
+
+/**
+ * Nearest neighbour of every point, queried on a k-d tree, O(n log n) expected.
+ * Queries go in the order of the tree, so consecutive ones visit the same nodes.
+ */
+static vector<int> allNearest(const vector<Point> &vp, WorkStealingPool *pool)
+{
+	KdTree tree(vp);
+	vector<int> nearest(vp.size(), -1);
+	forEachBlock(vp.size(), pool, [&](int, int begin, int end) {
+		for (int pos = begin; pos < end; pos++)
+		{
+			int q = tree.nearest(tree.point(pos), pos);
+			if (q >= 0)
+				nearest[tree.index(pos)] = tree.index(q);
+		}
+	});
+	return nearest;
+}
+
+vector<int> allNearestNeighbours(const vector<Point> &vp) {
+	return allNearest(vp, nullptr);
+}
+
+vector<int> allNearestNeighbours_MT(const vector<Point> &vp) {
+	return allNearest(vp, threadPool());
+}
+
+/**
+ * The k closest pairs. If (i, j), i < j, is one of them, j is one of the k
+ * nearest points to i with index greater than i (otherwise those k pairs
+ * would all be closer). So each point queries the k-d tree for those k
+ * points. Each block keeps its k best pairs in a bounded max-heap, and the
+ * heaps are merged at the end. The k-th pair of any full heap bounds the
+ * k-th pair overall, so the smallest of them is shared by all blocks and
+ * only closer points are searched. Pairs at the same distance as the k-th
+ * are chosen arbitrarily.
+ */
+static vector<Result> closestPairs(const vector<Point> &vp, int k, WorkStealingPool *pool)
+{
+	typedef pair<double, pair<int, int>> Pair; // squared distance, (i, j)
+	vector<Result> res;
+	if (k <= 0)
+		return res;
+	KdTree tree(vp);
+	int n = vp.size();
+	vector<vector<Pair>> heaps(blockCount(n, pool));
+	std::atomic<double> bound(MAX_DOUBLE); // squared
+	forEachBlock(n, pool, [&](int b, int begin, int end) {
+		vector<Pair> &heap = heaps[b];
+		vector<pair<double, int>> found;
+		for (int pos = begin; pos < end; pos++)
+		{
+			int i = tree.index(pos);
+			double limit2 = bound.load(std::memory_order_relaxed);
+			if ((int) heap.size() == k)
+			{
+				limit2 = std::min(limit2, heap.front().first);
+				double shared = bound.load(std::memory_order_relaxed);
+				while (limit2 < shared && !bound.compare_exchange_weak(shared, limit2, std::memory_order_relaxed))
+					;
+			}
+			tree.nearest(tree.point(pos), k, i, limit2, found);
+			for (auto &f : found)
+			{
+				if ((int) heap.size() == k)
+				{
+					if (f.first >= heap.front().first)
+						break;
+					std::pop_heap(heap.begin(), heap.end());
+					heap.pop_back();
+				}
+				heap.push_back(Pair(f.first, make_pair(i, f.second)));
+				std::push_heap(heap.begin(), heap.end());
+			}
+		}
+	});
+
+	vector<Pair> all;
+	for (auto &heap : heaps)
+		all.insert(all.end(), heap.begin(), heap.end());
+	std::sort(all.begin(), all.end());
+	if ((int) all.size() > k)
+		all.resize(k);
+	for (auto &p : all)
+		res.push_back(Result(sqrt(p.first), vp[p.second.first], vp[p.second.second]));
+	return res;
+}
+
+vector<Result> kClosestPairs(const vector<Point> &vp, int k) {
+	return closestPairs(vp, k, nullptr);
+}
+
+vector<Result> kClosestPairs_MT(const vector<Point> &vp, int k) {
+	return closestPairs(vp, k, threadPool());
 }
@@ -2,7 +2,9 @@
 #ifndef UTIL_H_
 #define UTIL_H_
 
+#include <string>
 #include "Point.h"
+#include "PointSet.h"
 
 /*
  * Auxiliary class to store a solution.
@@ -20,6 +22,29 @@ Result nearestPoints_BF(vector<Point> &vp);
 Result nearestPoints_BF_SortByX(vector<Point> &vp);
 Result nearestPoints_DC(vector<Point> &vp);
 Result nearestPoints_DC_MT(vector<Point> &vp);
+Result nearestPoints_DC_Merge(vector<Point> &vp);
+Result nearestPoints_DC_Merge_MT(vector<Point> &vp);
+Result nearestPoints_Grid(vector<Point> &vp);
+Result nearestPoints_StripY(vector<Point> &vp);
+
+// The same algorithms over x and y arrays (T = double or float)
+template <class T> Result nearestPoints_DC_Merge(PointSoA<T> &pts);
+template <class T> Result nearestPoints_DC_Merge_MT(PointSoA<T> &pts);
+template <class T> Result nearestPoints_Grid(PointSoA<T> &pts);
+
+// Closest pair of a point file (text or binary, see PointFile.h) that may not
+// fit in memory, keeping about chunkPoints points in memory at a time.
+// Returns false if the file or a temporary file could not be read or written.
+bool nearestPoints_External(const string &fileName, int chunkPoints, const string &tempPrefix, Result &res);
+
+// Nearest neighbour of each point: index in vp of the nearest other point (-1 if none)
+vector<int> allNearestNeighbours(const vector<Point> &vp);
+vector<int> allNearestNeighbours_MT(const vector<Point> &vp);
+
+// The k closest pairs of points, from the closest
+vector<Result> kClosestPairs(const vector<Point> &vp, int k);
+vector<Result> kClosestPairs_MT(const vector<Point> &vp, int k);
+
 void setNumThreads(int num);
 
 // Pointer to function that computes nearest points
@@ -0,0 +1,96 @@
+/*
+ * ParallelSort.h
+ */
+
+#ifndef PARALLELSORT_H_
+#define PARALLELSORT_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "WorkStealingPool.h"
+
+// Below this number of elements, or without a pool, std::sort is used
+const int SORT_CUTOFF = 1 << 16;
+// Sample elements taken per bucket to choose the splitters
+const int SORT_OVERSAMPLING = 32;
+
+/**
+ * Sample sort on the threads of "pool".
+ * Splitters taken from a random sample divide the values into buckets
+ * (several per thread, so that uneven buckets are balanced by stealing).
+ * Each block of the input finds the bucket of its elements and counts them;
+ * the counts give where every block writes each bucket, so the elements are
+ * scattered to a temporary vector without locks. Finally, the buckets are
+ * sorted independently and copied back.
+ * Equal elements always go to the same bucket, so a value repeated too many
+ * times ends up sorted by a single thread.
+ */
+template <class T, class Less>
+void parallelSort(std::vector<T> &v, Less less, WorkStealingPool *pool)
+{
+	int n = v.size();
+	if (pool == nullptr || pool->size() == 1 || n < SORT_CUTOFF)
+	{
+		std::sort(v.begin(), v.end(), less);
+		return;
+	}
+
+	int buckets = std::min(4 * pool->size(), 1024);
+	int blocks = buckets;
+	int blockSize = (n + blocks - 1) / blocks;
+
+	// Splitters: every SORT_OVERSAMPLING-th element of a sorted random sample
+	std::mt19937 gen(n);
+	std::uniform_int_distribution<int> dis(0, n - 1);
+	std::vector<T> sample(buckets * SORT_OVERSAMPLING);
+	for (auto &s : sample)
+		s = v[dis(gen)];
+	std::sort(sample.begin(), sample.end(), less);
+	std::vector<T> splitters(buckets - 1);
+	for (int k = 1; k < buckets; k++)
+		splitters[k - 1] = sample[k * SORT_OVERSAMPLING];
+
+	// Bucket of each element, counted per block: counts[b * buckets + k]
+	std::vector<uint16_t> bucketOf(n);
+	std::vector<int> counts(blocks * buckets, 0);
+	pool->parallelFor(0, blocks, [&](int b) {
+		int *count = &counts[b * buckets];
+		for (int i = b * blockSize, end = std::min(n, i + blockSize); i < end; i++)
+		{
+			int k = std::upper_bound(splitters.begin(), splitters.end(), v[i], less) - splitters.begin();
+			bucketOf[i] = k;
+			count[k]++;
+		}
+	});
+
+	// Counts become the position where each block writes each bucket
+	std::vector<int> start(buckets + 1);
+	int pos = 0;
+	for (int k = 0; k < buckets; k++)
+	{
+		start[k] = pos;
+		for (int b = 0; b < blocks; b++)
+		{
+			int count = counts[b * buckets + k];
+			counts[b * buckets + k] = pos;
+			pos += count;
+		}
+	}
+	start[buckets] = n;
+
+	std::vector<T> tmp(n);
+	pool->parallelFor(0, blocks, [&](int b) {
+		int *next = &counts[b * buckets];
+		for (int i = b * blockSize, end = std::min(n, i + blockSize); i < end; i++)
+			tmp[next[bucketOf[i]]++] = v[i];
+	});
+
+	pool->parallelFor(0, buckets, [&](int k) {
+		std::sort(tmp.begin() + start[k], tmp.begin() + start[k + 1], less);
+		std::copy(tmp.begin() + start[k], tmp.begin() + start[k + 1], v.begin() + start[k]);
+	});
+}
+
+#endif /* PARALLELSORT_H_ */
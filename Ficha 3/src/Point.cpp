@@ -9,14 +9,6 @@
 
 #include <cmath>
 
-Point::Point() {
-	// TODO Auto-generated constructor stub
-}
-
-Point::~Point() {
-	// TODO Auto-generated destructor stub
-}
-
 Point::Point(double x, double y) {
 	this->x = x;
 	this->y = y;
@@ -27,11 +19,11 @@ Point::Point(int x, int y) {
 	this->y = y;
 }
 
-double Point::distance(Point &p) {
+double Point::distance(const Point &p) const {
 	return sqrt((x-p.x) * (x-p.x)  + (y-p.y) * (y-p.y));
 }
 
-double Point::distSquare(Point &p) {
+double Point::distSquare(const Point &p) const {
 	return (x-p.x) * (x-p.x)  + (y-p.y) * (y-p.y);
 }
 
@@ -39,7 +31,7 @@ bool Point::operator==(const Point &p) const {
 	return (x == p.x && y == p.y);
 }
 
-ostream& operator<<(ostream& os, Point &p) {
+ostream& operator<<(ostream& os, const Point &p) {
 	os << "(" << p.x << "," << p.y << ")";
 	return os;
 }
@@ -7,23 +7,29 @@
 
 #include <iostream>
 #include <vector>
+#include <type_traits>
 
 using namespace std;
 
+/*
+ * Plain 16-byte point (no virtual functions), so vectors of points can be
+ * copied and sorted as raw memory.
+ */
 class Point {
 public:
 	double x;
 	double y;
 
-	Point();
+	Point() = default;
 	Point(double x, double y);
 	Point(int x, int y);
-	double distance(Point &p);
-	double distSquare(Point &p); // distance squared
-	virtual ~Point();
+	double distance(const Point &p) const;
+	double distSquare(const Point &p) const; // distance squared
 	bool operator==(const Point &p) const;
 };
-ostream& operator<<(ostream& os, Point &p);
+ostream& operator<<(ostream& os, const Point &p);
+
+static_assert(std::is_trivially_copyable<Point>::value, "Point must be trivially copyable");
 
 
 #endif /* POINT_H_ */
@@ -0,0 +1,184 @@
+/*
+ * PointFile.cpp
+ */
+
+#include "PointFile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const char POINT_FILE_MAGIC[8] = { 'P', 'O', 'I', 'N', 'T', 'S', '2', 'D' };
+
+PointReader::PointReader(const string &fileName)
+	: data(nullptr), size(0), pos(0), open(false), binary(false)
+{
+#ifdef _WIN32
+	mapping = nullptr;
+	file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+		return;
+	size = fileSize.QuadPart;
+	if (size > 0)
+	{
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+			return;
+		data = (const char *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == nullptr)
+			return;
+	}
+#else
+	fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+		return;
+	size = st.st_size;
+	if (size > 0)
+	{
+		void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED)
+			return;
+		madvise(p, size, MADV_SEQUENTIAL);
+		data = (const char *) p;
+	}
+#endif
+	open = true;
+	if (size >= sizeof(POINT_FILE_MAGIC) && memcmp(data, POINT_FILE_MAGIC, sizeof(POINT_FILE_MAGIC)) == 0)
+	{
+		binary = true;
+		pos = sizeof(POINT_FILE_MAGIC);
+	}
+}
+
+PointReader::~PointReader()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+#else
+	if (data != nullptr)
+		munmap((void *) data, size);
+	if (fd >= 0)
+		close(fd);
+#endif
+}
+
+bool PointReader::isOpen() const
+{
+	return open;
+}
+
+bool PointReader::isBinary() const
+{
+	return binary;
+}
+
+static inline bool isSpace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/**
+ * Parses the next number of a text file.
+ * Integers (as in the data files) are converted directly; other numbers
+ * are copied to a buffer for strtod, since the mapped file has no final '\0'.
+ * Returns false at the end of the file or on something that is not a number.
+ */
+bool PointReader::parseNumber(double &value)
+{
+	while (pos < size && isSpace(data[pos]))
+		pos++;
+	size_t start = pos;
+	while (pos < size && !isSpace(data[pos]))
+		pos++;
+	size_t len = pos - start;
+	if (len == 0)
+		return false;
+
+	const char *s = data + start;
+	size_t i = (s[0] == '-' || s[0] == '+') ? 1 : 0;
+	if (i < len && len - i <= 15)
+	{
+		long long n = 0;
+		size_t j = i;
+		for ( ; j < len && s[j] >= '0' && s[j] <= '9'; j++)
+			n = n * 10 + (s[j] - '0');
+		if (j == len)
+		{
+			value = (s[0] == '-') ? -(double) n : (double) n;
+			return true;
+		}
+	}
+
+	char buf[64];
+	if (len >= sizeof(buf))
+		return false;
+	memcpy(buf, s, len);
+	buf[len] = '\0';
+	char *end;
+	value = strtod(buf, &end);
+	return end == buf + len;
+}
+
+int PointReader::read(vector<Point> &vp, int max)
+{
+	int count = 0;
+	if (binary)
+	{
+		size_t available = (size - pos) / sizeof(Point);
+		if ((size_t) max < available)
+			available = max;
+		size_t first = vp.size();
+		vp.resize(first + available);
+		memcpy(vp.data() + first, data + pos, available * sizeof(Point));
+		pos += available * sizeof(Point);
+		return available;
+	}
+
+	double x, y;
+	// A number without its pair (or anything not a number) ends the file
+	while (count < max && parseNumber(x) && parseNumber(y))
+	{
+		vp.push_back(Point(x, y));
+		count++;
+	}
+	return count;
+}
+
+void readPointsFile(const string &fileName, vector<Point> &vp)
+{
+	vp.clear();
+	PointReader reader(fileName);
+	while (reader.read(vp, 1 << 20) > 0)
+		;
+}
+
+bool writePointsBinary(const string &fileName, const vector<Point> &vp)
+{
+	FILE *f = fopen(fileName.c_str(), "wb");
+	if (f == nullptr)
+		return false;
+	bool ok = fwrite(POINT_FILE_MAGIC, 1, sizeof(POINT_FILE_MAGIC), f) == sizeof(POINT_FILE_MAGIC)
+			&& fwrite(vp.data(), sizeof(Point), vp.size(), f) == vp.size();
+	return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,61 @@
+/*
+ * PointFile.h
+ */
+
+#ifndef POINTFILE_H_
+#define POINTFILE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Point.h"
+
+/*
+ * Point files, in two formats:
+ *  - text: x and y of each point separated by white space (Pontos8, ...);
+ *  - binary: the 8 bytes of POINT_FILE_MAGIC followed by x and y of each
+ *    point, as doubles in the byte order of the machine.
+ * The format is recognized by the first bytes of the file.
+ */
+extern const char POINT_FILE_MAGIC[8];
+
+/*
+ * Sequential reader of a point file, mapped in memory (mmap, or
+ * MapViewOfFile on Windows): the pages read are only cached by the system,
+ * so the file may be larger than the memory. Points are returned in chunks.
+ */
+class PointReader {
+public:
+	explicit PointReader(const string &fileName);
+	~PointReader();
+	PointReader(const PointReader &) = delete;
+	PointReader &operator=(const PointReader &) = delete;
+
+	bool isOpen() const;
+	bool isBinary() const;
+	// Appends up to max points to vp; returns how many were read (0 at the end)
+	int read(vector<Point> &vp, int max);
+
+private:
+	const char *data;
+	size_t size;
+	size_t pos;
+	bool open;
+	bool binary;
+#ifdef _WIN32
+	void *file;
+	void *mapping;
+#else
+	int fd;
+#endif
+
+	bool parseNumber(double &value);
+};
+
+// Reads all the points of a file (text or binary) to vp
+void readPointsFile(const string &fileName, vector<Point> &vp);
+
+// Writes vp in the binary format; returns false if the file could not be written
+bool writePointsBinary(const string &fileName, const vector<Point> &vp);
+
+#endif /* POINTFILE_H_ */
@@ -0,0 +1,23 @@
+/*
+ * PointGenerator.h
+ */
+
+#ifndef POINTGENERATOR_H_
+#define POINTGENERATOR_H_
+
+#include <vector>
+#include "Point.h"
+
+/*
+ * Random sets of points for tests and benchmarks. The same seed always
+ * gives the same points, so runs can be repeated and compared.
+ */
+const unsigned DEFAULT_SEED = 1;
+
+// Generates a vector of n distinct points with minimum distance 1.
+void generateRandom(int n, vector<Point> &vp, unsigned seed = DEFAULT_SEED);
+
+// Similar, but with constant X.
+void generateRandomConstX(int n, vector<Point> &vp, unsigned seed = DEFAULT_SEED);
+
+#endif /* POINTGENERATOR_H_ */
@@ -0,0 +1,96 @@
+/*
+ * PointSet.h
+ */
+
+#ifndef POINTSET_H_
+#define POINTSET_H_
+
+#include <algorithm>
+#include <vector>
+#include "Point.h"
+#include "ParallelSort.h"
+
+/*
+ * Point containers the closest-pair algorithms are templated over
+ * (see ClosestPair.h). Both give:
+ *   size(), x(i), y(i), point(i), copy(k, other, i), swap(i, j), sortByX(pool)
+ */
+
+/*
+ * Order by X, then by Y, of anything with x and y members.
+ */
+struct LessByX {
+	template <class P>
+	bool operator()(const P &p, const P &q) const {
+		return p.x < q.x || (p.x == q.x && p.y < q.y);
+	}
+};
+
+/*
+ * View of a vector<Point> (one 16-byte struct per point).
+ */
+class PointArray {
+	vector<Point> *v;
+public:
+	explicit PointArray(vector<Point> &v) : v(&v) {}
+
+	int size() const { return v->size(); }
+	double x(int i) const { return (*v)[i].x; }
+	double y(int i) const { return (*v)[i].y; }
+	Point point(int i) const { return (*v)[i]; }
+	void copy(int k, const PointArray &src, int i) { (*v)[k] = (*src.v)[i]; }
+	void swap(int i, int j) { std::swap((*v)[i], (*v)[j]); }
+	void sortByX(WorkStealingPool *pool = nullptr) { parallelSort(*v, LessByX(), pool); }
+};
+
+/*
+ * Structure of arrays: x and y in separate vectors, of type T (double, or
+ * float for half the memory when the coordinates fit in 24 bits).
+ */
+template <class T>
+class PointSoA {
+	vector<T> xs, ys;
+public:
+	PointSoA() {}
+	explicit PointSoA(int n) : xs(n), ys(n) {}
+	explicit PointSoA(const vector<Point> &vp);
+
+	int size() const { return xs.size(); }
+	double x(int i) const { return xs[i]; }
+	double y(int i) const { return ys[i]; }
+	Point point(int i) const { return Point((double)xs[i], (double)ys[i]); }
+	void copy(int k, const PointSoA &src, int i) { xs[k] = src.xs[i]; ys[k] = src.ys[i]; }
+	void swap(int i, int j) { std::swap(xs[i], xs[j]); std::swap(ys[i], ys[j]); }
+	void push_back(const Point &p) { xs.push_back(p.x); ys.push_back(p.y); }
+	void sortByX(WorkStealingPool *pool = nullptr);
+	size_t memoryUsage() const { return (xs.capacity() + ys.capacity()) * sizeof(T); }
+};
+
+template <class T>
+PointSoA<T>::PointSoA(const vector<Point> &vp)
+{
+	xs.reserve(vp.size());
+	ys.reserve(vp.size());
+	for (auto &p : vp)
+		push_back(p);
+}
+
+/**
+ * Sorts (x, y) pairs in a temporary array and writes them back.
+ */
+template <class T>
+void PointSoA<T>::sortByX(WorkStealingPool *pool)
+{
+	struct XY { T x, y; };
+	vector<XY> tmp(size());
+	for (int i = 0; i < size(); i++)
+		tmp[i] = { xs[i], ys[i] };
+	parallelSort(tmp, LessByX(), pool);
+	for (int i = 0; i < size(); i++)
+	{
+		xs[i] = tmp[i].x;
+		ys[i] = tmp[i].y;
+	}
+}
+
+#endif /* POINTSET_H_ */
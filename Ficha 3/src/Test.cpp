@@ -3,11 +3,19 @@
 #include "cute/xml_listener.h"
 #include "cute/cute_runner.h"
 
+#include <chrono>
 #include <fstream>
+#include <limits>
+#include <memory>
+#include <queue>
 #include <time.h>
 #include <sys/timeb.h>
 #include "Point.h"
 #include "NearestPoints.h"
+#include "ClosestPair.h"
+#include "PointFile.h"
+#include "PointGenerator.h"
+#include "DynamicClosestPair.h"
 #include <random>
 #include <stdlib.h>
 using namespace std;
@@ -17,86 +25,7 @@ using namespace std;
  * Auxiliary function to read points from file to vector.
  */
 void readPoints(string in, vector<Point> &vp){
-	ifstream is(in.c_str());
-	vp.clear();
-	if (!is)
-		return;
-	while (!is.eof()) {
-		double x, y;
-		is >> x >> y;
-		Point p(x,y);
-		vp.push_back(p);
-	}
-}
-
-/**
- * Auxiliary functions to generate random sets of points.
- */
-
-void shuffle(vector<Point> &vp, int left, int right)
-{
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dis(0, right - left +1);
-	for (int i = left; i < right; i++){
-		int k = i + dis(gen) % (right - i + 1);
-		Point tmp = vp[i];
-		vp[i] = vp[k];
-		vp[k] = tmp;
-	}
-}
-
-void shuffleY(vector<Point> &vp, int left, int right)
-{
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dis(0, right - left +1);
-	for (int i = left; i < right; i++){
-		int k = i + dis(gen) % (right - i + 1);
-		double tmp = vp[i].y;
-		vp[i].y = vp[k].y;
-		vp[k].y = tmp;
-	}
-}
-
-// Generates a vector of n distinct points with minimum distance 1.
-void generateRandom(int n, vector<Point> &vp) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dis(0, n-1);
-
-	vp.clear();
-	// reference value for reference points (r, r), (r, r+1)
-	int r = dis(gen);
-	vp.push_back(Point(r,r));
-	vp.push_back(Point(r,r+1));
-	for (int i = 2; i < n; i++)
-		if (i < r)
-			vp.push_back(Point(i, i));
-		else
-			vp.push_back(Point(i+1, i+2));
-	shuffleY(vp, 2, n-1);
-	shuffle(vp, 0, n-1);
-}
-
-// Similar, but with constant X.
-void generateRandomConstX(int n, vector<Point> &vp) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dis(0, n-1);
-
-	vp.clear();
-	// reference value for min dist
-	int r = dis(gen);
-	int y = 0;
-	for (int i = 0; i < n; i++) {
-		vp.push_back(Point(0, y));
-		if (i == r)
-			y++;
-		else
-			y += 1 + dis(gen) % 100;
-	}
-	shuffleY(vp, 0, n-1);
+	readPointsFile(in, vp);
 }
 
 /**
@@ -215,6 +144,92 @@ void testNP_DC() {
 	testNearestPoints(nearestPoints_DC, "Divide and conquer");
 }
 
+void testNP_DC_Merge() {
+	testNearestPoints(nearestPoints_DC_Merge, "Divide and conquer, merged by y");
+}
+
+void testNP_DC_Merge_8Threads() {
+	setNumThreads(8);
+	testNearestPoints(nearestPoints_DC_Merge_MT, "Divide and conquer, merged by y, with 8 threads");
+}
+
+void testNP_Grid() {
+	testNearestPoints(nearestPoints_Grid, "Randomized grid");
+	// whatever two points come first are the same point
+	vector<Point> same(100, Point(3, 4));
+	ASSERT_EQUAL(0.0, nearestPoints_Grid(same).dmin);
+	// cells of side 1e-150 next to a coordinate 1: indices out of int64_t
+	vector<Point> tiny = { Point(0, 0), Point(1e-150, 0.0), Point(1, 0) };
+	do
+		ASSERT_EQUAL(1e-150, nearestPoints_Grid(tiny).dmin);
+	while (next_permutation(tiny.begin(), tiny.end(), LessByX()));
+}
+
+/**
+ * Strip scan alone on the constant X data sets, where the strip is the whole input.
+ */
+void testNP_StripY_ConstX() {
+	cout << "algorithm; data set; time elapsed (ms); distance; point1; point2" << endl;
+	testNPRandConstX(0x8000, "Pontos32kConstX", 1.0, nearestPoints_StripY, "Strip scan by y");
+	testNPRandConstX(0x20000, "Pontos128kConstX", 1.0, nearestPoints_StripY, "Strip scan by y");
+	testNPRandConstX(0x80000, "Pontos512kConstX", 1.0, nearestPoints_StripY, "Strip scan by y");
+	testNPRandConstX(0x200000, "Pontos2MConstX", 1.0, nearestPoints_StripY, "Strip scan by y");
+}
+
+/**
+ * Same data in the three layouts (vector of Point, x/y arrays of double and
+ * of float): memory, sort time and closest pair time.
+ */
+template <class C>
+void testLayout(string layout, string name, C pts, size_t bytes, Result (*func)(C &)) {
+	int nTimeStart = GetMilliCount();
+	pts.sortByX();
+	int sortTime = GetMilliSpan(nTimeStart);
+	nTimeStart = GetMilliCount();
+	Result res = func(pts);
+	int nTimeElapsed = GetMilliSpan(nTimeStart);
+	cout << layout << "; " << name << "; " << bytes / pts.size() << " bytes/point; sort " << sortTime
+		<< "; closest pair " << nTimeElapsed << "; " << res.dmin << endl;
+	ASSERT_EQUAL_DELTA(1.0, res.dmin, 0.01);
+}
+
+Result mergeArray(PointArray &pts) {
+	vector<Point> auxPoints(pts.size());
+	PointArray aux(auxPoints);
+	return closestPairMerge(pts, aux, nullptr);
+}
+
+void testNP_Layouts() {
+	cout << "layout; data set; memory; sort by x (ms); divide and conquer, merged by y, with its sort (ms); distance" << endl;
+	vector<Point> pontos;
+	for (int constX = 0; constX < 2; constX++) {
+		string name = constX ? "Pontos2MConstX" : "Pontos2M";
+		if (constX)
+			generateRandomConstX(0x200000, pontos);
+		else
+			generateRandom(0x200000, pontos);
+
+		vector<Point> copy = pontos;
+		testLayout<PointArray>("vector<Point>", name, PointArray(copy), copy.capacity() * sizeof(Point), mergeArray);
+		PointSoA<double> soa(pontos);
+		testLayout<PointSoA<double>>("x/y double", name, soa, soa.memoryUsage(), nearestPoints_DC_Merge);
+		// float keeps 24 bits: the ConstX y coordinates go well above that
+		if (!constX) {
+			PointSoA<float> soaf(pontos);
+			testLayout<PointSoA<float>>("x/y float", name, soaf, soaf.memoryUsage(), nearestPoints_DC_Merge);
+		}
+	}
+}
+
+void testNP_Grid_SoA() {
+	vector<Point> pontos;
+	generateRandom(0x100000, pontos);
+	PointSoA<float> pts(pontos);
+	ASSERT_EQUAL_DELTA(1.0, nearestPoints_Grid(pts).dmin, 0.01);
+	setNumThreads(4);
+	ASSERT_EQUAL_DELTA(1.0, nearestPoints_DC_Merge_MT(pts).dmin, 0.01);
+}
+
 void testNP_DC_2Threads() {
 	setNumThreads(2);
 	testNearestPoints(nearestPoints_DC_MT, "Divide and conquer with 2 threads");
@@ -230,14 +245,358 @@ void testNP_DC_8Threads() {
 	testNearestPoints(nearestPoints_DC_MT, "Divide and conquer with 8 threads");
 }
 
+void testNP_DC_16Threads() {
+	setNumThreads(16);
+	testNearestPoints(nearestPoints_DC_MT, "Divide and conquer with 16 threads");
+}
+
+void testNP_DC_64Threads() {
+	setNumThreads(64);
+	testNearestPoints(nearestPoints_DC_MT, "Divide and conquer with 64 threads");
+}
+
+/**
+ * Runs func on random sets of 128k to 2M points, with each of the given
+ * numbers of threads (also set with setNumThreads), and checks the result it
+ * returns. Prints the time of each run.
+ */
+typedef double (*RAND_FUNC)(vector<Point> &pontos, int threads);
+
+void testNPRandThreads(string alg, vector<int> threadCounts, RAND_FUNC func, double expected) {
+	cout << "algorithm; data set; threads; time elapsed (ms); result" << endl;
+	int sizes[] = { 0x20000, 0x40000, 0x80000, 0x100000, 0x200000 };
+	string names[] = { "Pontos128k", "Pontos256k", "Pontos512k", "Pontos1M", "Pontos2M" };
+	for (int s = 0; s < 5; s++) {
+		vector<Point> pontos;
+		generateRandom(sizes[s], pontos);
+		for (int threads : threadCounts) {
+			setNumThreads(threads);
+			vector<Point> v = pontos;
+			int nTimeStart = GetMilliCount();
+			double result = func(v, threads);
+			int nTimeElapsed = GetMilliSpan(nTimeStart);
+			cout << alg << "; " << names[s] << "; " << threads << "; " << nTimeElapsed << "; " << result << endl;
+			ASSERT_EQUAL_DELTA(expected, result, 0.01);
+		}
+	}
+}
+
+/**
+ * Parallel sort by X on a pool kept between calls; 1 if the result is sorted.
+ */
+double sortByXThreads(vector<Point> &pontos, int threads) {
+	static unique_ptr<WorkStealingPool> pool;
+	if (!pool || pool->size() != threads)
+		pool.reset(new WorkStealingPool(threads));
+	parallelSort(pontos, LessByX(), pool.get());
+	return std::is_sorted(pontos.begin(), pontos.end(), LessByX()) ? 1.0 : 0.0;
+}
+
+double dcThreads(vector<Point> &pontos, int) {
+	return nearestPoints_DC_MT(pontos).dmin;
+}
+
+/**
+ * Scaling of the parallel sort by X, and of the whole divide and conquer
+ * that starts with it, from 1 to 8 threads.
+ */
+void testNP_SortScaling() {
+	// Same order as std::sort
+	vector<Point> pontos, sorted;
+	generateRandom(0x40000, pontos);
+	sorted = pontos;
+	std::sort(sorted.begin(), sorted.end(), LessByX());
+	sortByXThreads(pontos, 8);
+	for (unsigned i = 0; i < pontos.size(); i++) {
+		ASSERT_EQUAL(sorted[i].x, pontos[i].x);
+		ASSERT_EQUAL(sorted[i].y, pontos[i].y);
+	}
+
+	testNPRandThreads("Parallel sort by x", { 1, 2, 4, 8 }, sortByXThreads, 1.0);
+	testNPRandThreads("Divide and conquer", { 1, 2, 4, 8 }, dcThreads, 1.0);
+}
+
+/**
+ * A final new line (or any trailing white space) does not add a point.
+ */
+void testReadPoints() {
+	{
+		ofstream os("points.tmp");
+		os << "1 2\n-3 4.5\n\n";
+	}
+	vector<Point> vp;
+	readPoints("points.tmp", vp);
+	ASSERT_EQUAL(2, (int) vp.size());
+	ASSERT_EQUAL(-3.0, vp[1].x);
+	ASSERT_EQUAL(4.5, vp[1].y);
+
+	ASSERT(writePointsBinary("points.tmp", vp));
+	vector<Point> binary;
+	readPoints("points.tmp", binary);
+	ASSERT_EQUAL(2, (int) binary.size());
+	ASSERT(vp[0] == binary[0] && vp[1] == binary[1]);
+	remove("points.tmp");
+}
+
+/**
+ * Closest pair of files read in chunks (external memory), compared with
+ * the divide and conquer on the whole file in memory.
+ */
+void testExternalFile(string name, string file, int chunkPoints, double dmin) {
+	Result res;
+	int nTimeStart = GetMilliCount();
+	ASSERT(nearestPoints_External(file, chunkPoints, "external.tmp", res));
+	int nTimeElapsed = GetMilliSpan(nTimeStart);
+	cout << "External, chunks of " << chunkPoints << "; " << name << "; " << nTimeElapsed << "; ";
+	cout << res.dmin << "; " << res.p1 << "; " << res.p2 << endl;
+	ASSERT_EQUAL_DELTA(dmin, res.dmin, 0.01);
+}
+
+void testNP_External() {
+	cout << "algorithm; data set; time elapsed (ms); distance; point1; point2" << endl;
+	vector<Point> pontos;
+	readPoints("Pontos16k", pontos);
+	double dmin = nearestPoints_DC(pontos).dmin;
+	testExternalFile("Pontos16k", "Pontos16k", 0x400, dmin);
+	testExternalFile("Pontos128k", "Pontos128k", 0x4000, 0.0);
+
+	for (int constX = 0; constX < 2; constX++) {
+		string name = constX ? "Pontos2MConstX" : "Pontos2M";
+		if (constX)
+			generateRandomConstX(0x200000, pontos);
+		else
+			generateRandom(0x200000, pontos);
+		ASSERT(writePointsBinary("points.tmp", pontos));
+		pontos.clear();
+		testExternalFile(name + " (binary)", "points.tmp", 0x40000, 1.0);
+		testExternalFile(name + " (binary)", "points.tmp", 0x1000, 1.0);
+		remove("points.tmp");
+	}
+
+	// Files that cannot be read or written are reported, not skipped
+	Result res;
+	ASSERT(!nearestPoints_External("NoSuchFile", 0x1000, "external.tmp", res));
+	ASSERT(!nearestPoints_External("Pontos16k", 0x400, "no-such-dir/external.tmp", res));
+}
+/**
+ * Smallest distance from a point to its nearest neighbour (the closest pair).
+ */
+double annThreads(vector<Point> &pontos, int threads) {
+	vector<int> nearest = (threads == 1) ? allNearestNeighbours(pontos) : allNearestNeighbours_MT(pontos);
+	double dmin = numeric_limits<double>::max();
+	for (unsigned i = 0; i < pontos.size(); i++)
+		dmin = min(dmin, pontos[i].distance(pontos[nearest[i]]));
+	return dmin;
+}
+
+/**
+ * Nearest neighbour of every point: checked by brute force on the small
+ * files (Pontos16k spans several query blocks of the threaded version),
+ * then timed with 1 and 4 threads.
+ */
+void testAllNearestNeighbours() {
+	string files[] = { "Pontos1k", "Pontos16k" };
+	setNumThreads(4);
+	for (auto &file : files) {
+		vector<Point> pontos;
+		readPoints(file, pontos);
+		vector<int> nearest = allNearestNeighbours(pontos);
+		vector<int> nearestMT = allNearestNeighbours_MT(pontos);
+		ASSERT_EQUAL(pontos.size(), nearestMT.size());
+		for (unsigned i = 0; i < pontos.size(); i++) {
+			double best = numeric_limits<double>::max();
+			for (unsigned j = 0; j < pontos.size(); j++)
+				if (j != i)
+					best = min(best, pontos[i].distance(pontos[j]));
+			ASSERT_EQUAL_DELTA(best, pontos[i].distance(pontos[nearest[i]]), 1e-9);
+			ASSERT_EQUAL_DELTA(best, pontos[i].distance(pontos[nearestMT[i]]), 1e-9);
+		}
+	}
+
+	testNPRandThreads("All nearest neighbours", { 1, 4 }, annThreads, 1.0);
+}
+
+/**
+ * Distance of the closest of the 1000 closest pairs.
+ */
+double kClosestThreads(vector<Point> &pontos, int threads) {
+	vector<Result> pairs = (threads == 1) ? kClosestPairs(pontos, 1000) : kClosestPairs_MT(pontos, 1000);
+	ASSERT_EQUAL(1000, (int) pairs.size());
+	return pairs.front().dmin;
+}
+
+/**
+ * The k smallest distances between pairs of points, by brute force.
+ */
+vector<double> kClosestDistancesBF(const vector<Point> &pontos, int k) {
+	priority_queue<double> best; // the k smallest so far, largest on top
+	for (unsigned i = 0; i < pontos.size(); i++)
+		for (unsigned j = i + 1; j < pontos.size(); j++) {
+			double d = pontos[i].distance(pontos[j]);
+			if ((int) best.size() < k)
+				best.push(d);
+			else if (d < best.top()) {
+				best.pop();
+				best.push(d);
+			}
+		}
+	vector<double> all(best.size());
+	for (int i = all.size() - 1; i >= 0; i--) {
+		all[i] = best.top();
+		best.pop();
+	}
+	return all;
+}
+
+/**
+ * The k closest pairs: checked by brute force on Pontos1k and on Pontos16k
+ * (several query blocks of the threaded version, sharing the bound), then
+ * timed with 1 and 4 threads for k = 1000.
+ */
+void testKClosestPairs() {
+	string files[] = { "Pontos1k", "Pontos16k" };
+	int ks[] = { 100, 5000 };
+	setNumThreads(4);
+	for (int f = 0; f < 2; f++) {
+		vector<Point> pontos;
+		readPoints(files[f], pontos);
+		int k = ks[f];
+		vector<double> all = kClosestDistancesBF(pontos, k);
+		vector<Result> pairs = kClosestPairs(pontos, k);
+		vector<Result> pairsMT = kClosestPairs_MT(pontos, k);
+		ASSERT_EQUAL(k, (int) pairs.size());
+		ASSERT_EQUAL(k, (int) pairsMT.size());
+		for (int i = 0; i < k; i++) {
+			ASSERT_EQUAL_DELTA(all[i], pairs[i].dmin, 1e-9);
+			ASSERT_EQUAL_DELTA(all[i], pairsMT[i].dmin, 1e-9);
+			ASSERT_EQUAL_DELTA(pairs[i].dmin, pairs[i].p1.distance(pairs[i].p2), 1e-9);
+			ASSERT_EQUAL_DELTA(pairsMT[i].dmin, pairsMT[i].p1.distance(pairsMT[i].p2), 1e-9);
+		}
+	}
+
+	testNPRandThreads("1000 closest pairs", { 1, 4 }, kClosestThreads, 1.0);
+}
+
+/**
+ * Random insertions, deletions and moves, checking the closest pair after
+ * each one by brute force.
+ */
+void testDynamicClosestPair() {
+	std::mt19937 gen(DEFAULT_SEED);
+	std::uniform_int_distribution<int> coord(0, 2000);
+	DynamicClosestPair set;
+	vector<int> ids;
+	for (int step = 0; step < 5000; step++) {
+		int op = gen() % 4;
+		if (ids.size() < 2 || (op <= 1 && ids.size() < 300))
+			ids.push_back(set.insert(Point(coord(gen), coord(gen))));
+		else if (op == 2) {
+			int k = gen() % ids.size();
+			set.erase(ids[k]);
+			ids[k] = ids.back();
+			ids.pop_back();
+		}
+		else
+			set.move(ids[gen() % ids.size()], Point(coord(gen), coord(gen)));
+
+		vector<Point> pontos;
+		for (int id : ids)
+			pontos.push_back(set.point(id));
+		Result res = set.closest();
+		ASSERT_EQUAL((int) ids.size(), set.size());
+		ASSERT_EQUAL_DELTA(nearestPoints_BF(pontos).dmin, res.dmin, 1e-9);
+		if (ids.size() >= 2)
+			ASSERT_EQUAL_DELTA(res.dmin, res.p1.distance(res.p2), 1e-9);
+	}
+
+	// Cell indices must stay in int64_t: a tiny closest pair, then a point far out
+	DynamicClosestPair far;
+	far.insert(Point(0, 0));
+	far.insert(Point(1e-150, 0.0));
+	far.insert(Point(1, 0));
+	ASSERT_EQUAL(1e-150, far.closest().dmin);
+	int id = far.insert(Point(1e200, 0.0));
+	ASSERT_EQUAL(1e-150, far.closest().dmin);
+	far.move(id, Point(-1e250, 3.0));
+	ASSERT_EQUAL(1e-150, far.closest().dmin);
+	far.erase(1);
+	ASSERT_EQUAL(1.0, far.closest().dmin);
+}
+
+/**
+ * Seconds since start, from steady_clock (nanosecond ticks, no rollover).
+ */
+double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Update throughput with 1M points: each update moves a random point to a
+ * random place and asks for the closest pair. The moves are generated
+ * before timing.
+ */
+void testDynamicClosestPair_1M() {
+	cout << "operation; data set; time elapsed (ms); operations per second; distance" << endl;
+	int n = 0x100000, updates = 0x100000;
+	vector<Point> pontos;
+	generateRandom(n, pontos);
+	DynamicClosestPair set;
+	vector<int> ids(n);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; i++)
+		ids[i] = set.insert(pontos[i]);
+	Result res = set.closest();
+	double seconds = secondsSince(start);
+	cout << "Insert; Pontos1M; " << seconds * 1000 << "; " << (long long) (n / seconds)
+		<< "; " << res.dmin << endl;
+	ASSERT_EQUAL_DELTA(1.0, res.dmin, 0.01);
+
+	std::mt19937 gen(DEFAULT_SEED);
+	std::uniform_int_distribution<int> coord(0, 8 * n);
+	vector<int> moved(updates);
+	vector<Point> targets(updates);
+	for (int u = 0; u < updates; u++) {
+		moved[u] = gen() % n;
+		targets[u] = Point(coord(gen), coord(gen));
+	}
+	double sum = 0;
+	start = std::chrono::steady_clock::now();
+	for (int u = 0; u < updates; u++) {
+		set.move(ids[moved[u]], targets[u]);
+		sum += set.closest().dmin;
+	}
+	seconds = secondsSince(start);
+	for (int u = 0; u < updates; u++)
+		pontos[moved[u]] = targets[u];
+	res = set.closest();
+	cout << "Move and query; Pontos1M; " << seconds * 1000 << "; " << (long long) (updates / seconds)
+		<< "; " << res.dmin << endl;
+	ASSERT(sum > 0);
+	ASSERT_EQUAL_DELTA(nearestPoints_DC(pontos).dmin, res.dmin, 1e-9);
+}
 
 bool runAllTests(int argc, char const *argv[]) {
 	cute::suite s { };
 	//s.push_back(CUTE(testNP_BF));
 	s.push_back(CUTE(testNP_DC));
+	s.push_back(CUTE(testNP_DC_Merge));
+	s.push_back(CUTE(testNP_DC_Merge_8Threads));
+	s.push_back(CUTE(testNP_Grid));
+	s.push_back(CUTE(testNP_StripY_ConstX));
+	s.push_back(CUTE(testNP_Layouts));
+	s.push_back(CUTE(testNP_Grid_SoA));
 	s.push_back(CUTE(testNP_DC_2Threads));
 	s.push_back(CUTE(testNP_DC_4Threads));
 	s.push_back(CUTE(testNP_DC_8Threads));
+	s.push_back(CUTE(testNP_DC_16Threads));
+	s.push_back(CUTE(testNP_DC_64Threads));
+	s.push_back(CUTE(testNP_SortScaling));
+	s.push_back(CUTE(testReadPoints));
+	s.push_back(CUTE(testNP_External));
+	s.push_back(CUTE(testAllNearestNeighbours));
+	s.push_back(CUTE(testKClosestPairs));
+	s.push_back(CUTE(testDynamicClosestPair));
+	s.push_back(CUTE(testDynamicClosestPair_1M));
 	s.push_back(CUTE(testNP_BF_SortedX));
 	cute::xml_file_opener xmlfile(argc, argv);
 	cute::xml_listener<cute::ide_listener<>> lis(xmlfile.out);
@@ -246,6 +605,9 @@ bool runAllTests(int argc, char const *argv[]) {
 	return success;
 }
 
+// The benchmark build (-DBENCHMARK) has its own main, in Benchmark.cpp
+#ifndef BENCHMARK
 int main(int argc, char const *argv[]) {
     return runAllTests(argc, argv) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
+#endif
@@ -0,0 +1,129 @@
+/*
+ * WorkStealingPool.cpp
+ */
+
+#include "WorkStealingPool.h"
+
+// Pool and queue of the current thread (pool threads only)
+static thread_local const WorkStealingPool *currentPool = nullptr;
+static thread_local int currentIndex = 0;
+
+WorkStealingPool::WorkStealingPool(int numThreads)
+{
+	numWorkers = (numThreads < 1) ? 1 : numThreads;
+	for (int i = 0; i < numWorkers; i++)
+		queues.emplace_back(new Queue());
+	for (int i = 1; i < numWorkers; i++)
+		threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	stop = true;
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wakeUp.notify_all();
+	for (auto &t : threads)
+		t.join();
+}
+
+int WorkStealingPool::size() const
+{
+	return numWorkers;
+}
+
+/**
+ * Index of the queue of the calling thread (0 for threads outside the pool).
+ */
+int WorkStealingPool::self() const
+{
+	return (currentPool == this) ? currentIndex : 0;
+}
+
+void WorkStealingPool::push(Task *t)
+{
+	Queue &q = *queues[self()];
+	{
+		std::lock_guard<std::mutex> lock(q.m);
+		q.tasks.push_back(t);
+	}
+	pending++;
+	// Taking the lock avoids losing the wake up of a thread about to sleep
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wakeUp.notify_one();
+}
+
+/**
+ * Removes t from the back of the own queue, unless it was stolen.
+ */
+bool WorkStealingPool::takeBack(Task *t)
+{
+	Queue &q = *queues[self()];
+	std::lock_guard<std::mutex> lock(q.m);
+	if (q.tasks.empty() || q.tasks.back() != t)
+		return false;
+	q.tasks.pop_back();
+	pending--;
+	return true;
+}
+
+WorkStealingPool::Task *WorkStealingPool::steal(int thief)
+{
+	for (int k = 1; k < numWorkers; k++)
+	{
+		Queue &q = *queues[(thief + k) % numWorkers];
+		std::lock_guard<std::mutex> lock(q.m);
+		if (!q.tasks.empty())
+		{
+			Task *t = q.tasks.front();
+			q.tasks.pop_front();
+			pending--;
+			return t;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Runs one task: the newest of the own queue or one stolen from another.
+ */
+bool WorkStealingPool::runOne()
+{
+	int id = self();
+	Task *t = nullptr;
+	{
+		Queue &q = *queues[id];
+		std::lock_guard<std::mutex> lock(q.m);
+		if (!q.tasks.empty())
+		{
+			t = q.tasks.back();
+			q.tasks.pop_back();
+			pending--;
+		}
+	}
+	if (t == nullptr)
+		t = steal(id);
+	if (t == nullptr)
+		return false;
+
+	t->fn();
+	// The task lives on the stack of invoke(): it may be gone after this
+	t->done.store(true, std::memory_order_release);
+	return true;
+}
+
+void WorkStealingPool::workerLoop(int id)
+{
+	currentPool = this;
+	currentIndex = id;
+	while (!stop)
+	{
+		if (runOne())
+			continue;
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [this] { return stop || pending > 0; });
+	}
+}
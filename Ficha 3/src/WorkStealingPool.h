@@ -0,0 +1,98 @@
+/*
+ * WorkStealingPool.h
+ */
+
+#ifndef WORKSTEALINGPOOL_H_
+#define WORKSTEALINGPOOL_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0501
+#endif
+#include "mingw.thread.h"
+#include "mingw.mutex.h"
+#include "mingw.condition_variable.h"
+
+/*
+ * Fork-join thread pool: each thread keeps its own task queue, takes the
+ * newest task from it and, when it runs out, steals the oldest task of
+ * another thread (the biggest piece of work left in a divide and conquer).
+ * The thread that calls invoke() also works while it waits.
+ */
+class WorkStealingPool {
+public:
+	explicit WorkStealingPool(int numThreads);
+	~WorkStealingPool();
+	int size() const;
+
+	// Runs a and b, possibly in parallel; returns when both are done.
+	template <class A, class B>
+	void invoke(A a, B b);
+
+	// Runs f(i) for i in [begin, end), splitting the range in halves.
+	template <class F>
+	void parallelFor(int begin, int end, F f);
+
+private:
+	struct Task {
+		std::function<void()> fn;
+		std::atomic<bool> done { false };
+	};
+	struct Queue {
+		std::mutex m;
+		std::deque<Task *> tasks;
+	};
+
+	int numWorkers;
+	std::vector<std::unique_ptr<Queue>> queues; // queues[0]: calling thread
+	std::vector<std::thread> threads;
+	std::atomic<bool> stop { false };
+	std::atomic<int> pending { 0 };             // tasks waiting in the queues
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+
+	int self() const;
+	void push(Task *t);
+	bool takeBack(Task *t);
+	Task *steal(int thief);
+	bool runOne();
+	void workerLoop(int id);
+};
+
+template <class A, class B>
+void WorkStealingPool::invoke(A a, B b)
+{
+	Task tb;
+	tb.fn = b;
+	push(&tb);
+	a();
+	// If nobody stole b, run it here; otherwise help with other tasks until it is done
+	if (takeBack(&tb))
+		b();
+	else
+		while (!tb.done.load(std::memory_order_acquire))
+			if (!runOne())
+				std::this_thread::yield();
+}
+
+template <class F>
+void WorkStealingPool::parallelFor(int begin, int end, F f)
+{
+	if (end - begin <= 0)
+		return;
+	if (end - begin == 1)
+	{
+		f(begin);
+		return;
+	}
+	int mid = (begin + end) / 2;
+	invoke([&] { parallelFor(begin, mid, f); },
+		   [&] { parallelFor(mid, end, f); });
+}
+
+#endif /* WORKSTEALINGPOOL_H_ */
@@ -0,0 +1,407 @@
+/*
+ * ChainCompression.h
+ * Road graph with its degree-2 chains contracted.
+ *
+ * A vertex is "interior" when it has exactly two distinct neighbours and the
+ * road just passes through it (one-way in one direction, or two-way). Every
+ * maximal chain of interior vertices becomes a single weighted edge per
+ * direction between the two kept vertices at its ends, remembering the
+ * original vertices and edge IDs.
+ *
+ * Queries take and return original vertices: sources and targets may be
+ * interior (the search starts/ends part-way along their chain), and paths
+ * are expanded back to the full vertex and edge sequence.
+ */
+
+#ifndef CHAINCOMPRESSION_H_
+#define CHAINCOMPRESSION_H_
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <cstdint>
+#include "Graph.h"
+
+template <class T, class Alloc = ArenaPolicy>
+class ChainCompressedGraph {
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	struct Chain {
+		vector<uint32_t> seq;       // original indices: from, interior..., to
+		vector<double> fwdCum;      // distance from seq[0] to seq[j]
+		vector<double> bwdCum;      // distance from seq.back() to seq[j]
+		vector<int> fwdEdges;       // edge seq[j] -> seq[j+1]
+		vector<int> bwdEdges;       // edge seq[j+1] -> seq[j]
+		bool forward = true, backward = true;
+	};
+	struct Arc {
+		uint32_t to;                // kept vertex (compressed index)
+		double weight;
+		int32_t edgeID;             // original edge (plain arcs)
+		int32_t chain;              // -1 plain, else 2 * chain + backward
+	};
+
+	const Graph<T, Alloc> &graph;
+	vector<uint32_t> kept;          // compressed index -> original index
+	vector<uint32_t> compressed;    // original index -> compressed index, NONE if interior
+	vector<uint32_t> chainOf, posOf;    // interior vertices: chain and position in seq
+	vector<Chain> chains;
+	vector<uint32_t> firstArc;      // CSR over kept vertices
+	vector<Arc> arcs;
+
+	// Last query
+	uint32_t source = NONE;
+	vector<double> dist;
+	vector<uint32_t> parentArc;     // arc index, or NONE for a seed
+	vector<bool> seedBackward;      // seed reached by leaving the source's chain backwards
+
+	bool isInterior(const Vertex<T> *v) const;
+	uint32_t edgeTo(uint32_t from, uint32_t to, double &w, int &id) const;
+	double arrival(uint32_t dest, int &how) const;
+
+public:
+	ChainCompressedGraph(const Graph<T, Alloc> &graph);
+
+	unsigned getNumVertex() const { return kept.size(); }
+	unsigned getNumEdges() const { return arcs.size(); }
+	unsigned getNumChains() const { return chains.size(); }
+
+	void dijkstraShortestPath(const T &s);
+	double getDist(const T &dest) const;
+	bool getPath(const T &dest, vector<T> &nodes, vector<int> &edgeIDs) const;
+	vector<T> getPath(const T &dest) const;
+};
+
+/*
+ * Interior: exactly two distinct neighbours a, b, and the edges are
+ * a -> v -> b, b -> v -> a, or both.
+ */
+template <class T, class Alloc>
+bool ChainCompressedGraph<T, Alloc>::isInterior(const Vertex<T> *v) const {
+	vector<unsigned> in, out;
+	for (auto &e : v->getOutgoing())
+		if (find(out.begin(), out.end(), e.getDest()) == out.end())
+			out.push_back(e.getDest());
+	for (auto &r : v->getIngoing())
+		if (find(in.begin(), in.end(), r.getOrig()) == in.end())
+			in.push_back(r.getOrig());
+	unsigned self = v->getIndex();
+	if (find(in.begin(), in.end(), self) != in.end() || find(out.begin(), out.end(), self) != out.end())
+		return false;
+
+	sort(in.begin(), in.end());
+	sort(out.begin(), out.end());
+	if (in.size() == 1 && out.size() == 1)
+		return in[0] != out[0];
+	return in.size() == 2 && in == out;
+}
+
+/*
+ * Cheapest edge from -> to (original indices); returns NONE if there is none.
+ */
+template <class T, class Alloc>
+uint32_t ChainCompressedGraph<T, Alloc>::edgeTo(uint32_t from, uint32_t to, double &w, int &id) const {
+	uint32_t res = NONE;
+	auto &out = graph.getVertex(from)->getOutgoing();
+	for (uint32_t i = 0; i < out.size(); i++)
+		if (out[i].getDest() == to && (res == NONE || out[i].getWeight() < w)) {
+			res = i;
+			w = out[i].getWeight();
+			id = out[i].getEdgeID();
+		}
+	return res;
+}
+
+template <class T, class Alloc>
+ChainCompressedGraph<T, Alloc>::ChainCompressedGraph(const Graph<T, Alloc> &graph) : graph(graph) {
+	unsigned n = graph.getNumVertex();
+	vector<bool> interior(n);
+	for (unsigned i = 0; i < n; i++)
+		interior[i] = isInterior(graph.getVertex(i));
+
+	chainOf.assign(n, NONE);
+	posOf.assign(n, NONE);
+
+	auto neighbours = [&](uint32_t v) {
+		vector<uint32_t> res;
+		for (auto &e : graph.getVertex(v)->getOutgoing())
+			res.push_back(e.getDest());
+		for (auto &r : graph.getVertex(v)->getIngoing())
+			res.push_back(r.getOrig());
+		sort(res.begin(), res.end());
+		res.erase(unique(res.begin(), res.end()), res.end());
+		return res;
+	};
+
+	// Percorrer as cadeias a partir dos vértices que ficam
+	for (uint32_t u = 0; u < n; u++) {
+		if (interior[u])
+			continue;
+		for (uint32_t w : neighbours(u)) {
+			if (!interior[w] || chainOf[w] != NONE)
+				continue;
+			Chain c;
+			c.seq.push_back(u);
+			uint32_t prev = u, cur = w;
+			while (interior[cur] && chainOf[cur] == NONE) {
+				chainOf[cur] = chains.size();
+				posOf[cur] = c.seq.size();
+				c.seq.push_back(cur);
+				auto nb = neighbours(cur);
+				uint32_t next = (nb[0] == prev) ? nb[1] : nb[0];
+				prev = cur;
+				cur = next;
+			}
+			c.seq.push_back(cur);
+
+			size_t k = c.seq.size() - 1;
+			c.fwdCum.assign(k + 1, 0);
+			c.bwdCum.assign(k + 1, 0);
+			c.fwdEdges.assign(k, -1);
+			c.bwdEdges.assign(k, -1);
+			for (size_t j = 0; j < k; j++) {
+				double w1 = 0, w2 = 0;
+				c.forward = c.forward && edgeTo(c.seq[j], c.seq[j + 1], w1, c.fwdEdges[j]) != NONE;
+				c.backward = c.backward && edgeTo(c.seq[j + 1], c.seq[j], w2, c.bwdEdges[j]) != NONE;
+				c.fwdCum[j + 1] = c.fwdCum[j] + w1;
+			}
+			for (size_t j = k; j > 0; j--) {
+				double w2 = 0;
+				int id;
+				edgeTo(c.seq[j], c.seq[j - 1], w2, id);
+				c.bwdCum[j - 1] = c.bwdCum[j] + w2;
+			}
+			chains.push_back(c);
+		}
+	}
+
+	// Vértices que ficam (incluindo ciclos só de vértices interiores)
+	compressed.assign(n, NONE);
+	for (uint32_t v = 0; v < n; v++)
+		if (!interior[v] || chainOf[v] == NONE) {
+			compressed[v] = kept.size();
+			kept.push_back(v);
+			chainOf[v] = posOf[v] = NONE;
+		}
+
+	// Arestas: as originais entre vértices que ficam, mais uma por cadeia e sentido
+	vector<vector<Arc>> out(kept.size());
+	for (uint32_t i = 0; i < kept.size(); i++)
+		for (auto &e : graph.getVertex(kept[i])->getOutgoing())
+			if (compressed[e.getDest()] != NONE)
+				out[i].push_back({ compressed[e.getDest()], e.getWeight(), e.getEdgeID(), -1 });
+	for (uint32_t c = 0; c < chains.size(); c++) {
+		auto &ch = chains[c];
+		uint32_t a = compressed[ch.seq.front()], b = compressed[ch.seq.back()];
+		if (ch.forward)
+			out[a].push_back({ b, ch.fwdCum.back(), -1, (int32_t)(2 * c) });
+		if (ch.backward)
+			out[b].push_back({ a, ch.bwdCum.front(), -1, (int32_t)(2 * c + 1) });
+	}
+	firstArc.assign(kept.size() + 1, 0);
+	for (uint32_t i = 0; i < kept.size(); i++) {
+		firstArc[i + 1] = firstArc[i] + out[i].size();
+		arcs.insert(arcs.end(), out[i].begin(), out[i].end());
+	}
+}
+
+/*
+ * Dijkstra over the kept vertices. An interior source seeds the ends of
+ * its chain that can be reached from it.
+ */
+template <class T, class Alloc>
+void ChainCompressedGraph<T, Alloc>::dijkstraShortestPath(const T &s) {
+	dist.assign(kept.size(), INF);
+	parentArc.assign(kept.size(), NONE);
+	seedBackward.assign(kept.size(), false);
+	auto sv = graph.findVertex(s);
+	source = (sv == nullptr) ? NONE : sv->getIndex();
+	if (source == NONE)
+		return;
+
+	typedef pair<double, uint32_t> QueueEntry;
+	priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry>> q;
+	if (compressed[source] != NONE) {
+		dist[compressed[source]] = 0;
+		q.push({ 0, compressed[source] });
+	}
+	else {
+		auto &ch = chains[chainOf[source]];
+		uint32_t p = posOf[source];
+		if (ch.forward) {
+			uint32_t b = compressed[ch.seq.back()];
+			dist[b] = ch.fwdCum.back() - ch.fwdCum[p];
+			q.push({ dist[b], b });
+		}
+		if (ch.backward) {
+			uint32_t a = compressed[ch.seq.front()];
+			double d = ch.bwdCum.front() - ch.bwdCum[p];
+			if (d < dist[a]) {
+				dist[a] = d;
+				seedBackward[a] = true;
+				q.push({ d, a });
+			}
+		}
+	}
+
+	while (!q.empty()) {
+		auto top = q.top();
+		q.pop();
+		uint32_t v = top.second;
+		if (top.first > dist[v])
+			continue;
+		for (uint32_t i = firstArc[v]; i < firstArc[v + 1]; i++) {
+			const Arc &a = arcs[i];
+			if (dist[v] + a.weight < dist[a.to]) {
+				dist[a.to] = dist[v] + a.weight;
+				parentArc[a.to] = i;
+				q.push({ dist[a.to], a.to });
+			}
+		}
+	}
+}
+
+/*
+ * Distance to an original vertex. "how" tells the last leg:
+ * 0 kept vertex, 1 from the chain start, 2 from the chain end,
+ * 3 along the source's own chain.
+ */
+template <class T, class Alloc>
+double ChainCompressedGraph<T, Alloc>::arrival(uint32_t dest, int &how) const {
+	how = 0;
+	if (source == NONE)
+		return INF;
+	if (compressed[dest] != NONE)
+		return dist[compressed[dest]];
+
+	auto &ch = chains[chainOf[dest]];
+	uint32_t q = posOf[dest];
+	double best = INF;
+	if (ch.forward && dist[compressed[ch.seq.front()]] + ch.fwdCum[q] < best) {
+		best = dist[compressed[ch.seq.front()]] + ch.fwdCum[q];
+		how = 1;
+	}
+	if (ch.backward && dist[compressed[ch.seq.back()]] + ch.bwdCum[q] < best) {
+		best = dist[compressed[ch.seq.back()]] + ch.bwdCum[q];
+		how = 2;
+	}
+	if (compressed[source] == NONE && chainOf[source] == chainOf[dest]) {
+		uint32_t p = posOf[source];
+		if (p == q) {
+			how = 3;
+			return 0;
+		}
+		double d = (q > p) ? (ch.forward ? ch.fwdCum[q] - ch.fwdCum[p] : INF) : (ch.backward ? ch.bwdCum[q] - ch.bwdCum[p] : INF);
+		if (d <= best) {
+			best = d;
+			how = 3;
+		}
+	}
+	return best;
+}
+
+template <class T, class Alloc>
+double ChainCompressedGraph<T, Alloc>::getDist(const T &dest) const {
+	auto v = graph.findVertex(dest);
+	if (v == nullptr)
+		return INF;
+	int how;
+	return arrival(v->getIndex(), how);
+}
+
+/*
+ * Full path to dest, as original vertices and the original edge IDs between
+ * them. Returns false if dest is missing or unreachable.
+ */
+template <class T, class Alloc>
+bool ChainCompressedGraph<T, Alloc>::getPath(const T &dest, vector<T> &nodes, vector<int> &edgeIDs) const {
+	nodes.clear();
+	edgeIDs.clear();
+	auto dv = graph.findVertex(dest);
+	if (dv == nullptr)
+		return false;
+	int how;
+	uint32_t d = dv->getIndex();
+	if (arrival(d, how) == INF)
+		return false;
+
+	// Construído de trás para a frente
+	vector<uint32_t> seq;
+	vector<int> ids;
+	auto walkChain = [&](const Chain &ch, size_t from, size_t to) {
+		// seq[from] -> seq[to] (exclusive of seq[from])
+		if (to > from)
+			for (size_t j = to; j > from; j--) {
+				seq.push_back(ch.seq[j]);
+				ids.push_back(ch.fwdEdges[j - 1]);
+			}
+		else
+			for (size_t j = to; j < from; j++) {
+				seq.push_back(ch.seq[j]);
+				ids.push_back(ch.bwdEdges[j]);
+			}
+	};
+
+	uint32_t v;    // kept vertex where the search part ends
+	if (how == 3) {
+		auto &ch = chains[chainOf[d]];
+		walkChain(ch, posOf[source], posOf[d]);
+		v = NONE;
+	}
+	else if (how == 0)
+		v = compressed[d];
+	else {
+		auto &ch = chains[chainOf[d]];
+		size_t end = (how == 1) ? 0 : ch.seq.size() - 1;
+		walkChain(ch, end, posOf[d]);
+		v = compressed[ch.seq[end]];
+	}
+
+	while (v != NONE && parentArc[v] != NONE) {
+		const Arc &a = arcs[parentArc[v]];
+		uint32_t u = NONE;
+		if (a.chain < 0) {
+			seq.push_back(kept[v]);
+			ids.push_back(a.edgeID);
+		}
+		else {
+			auto &ch = chains[a.chain / 2];
+			bool backward = a.chain % 2;
+			size_t from = backward ? ch.seq.size() - 1 : 0;
+			walkChain(ch, from, ch.seq.size() - 1 - from);
+		}
+		// Vértice de origem do arco
+		u = upper_bound(firstArc.begin(), firstArc.end(), parentArc[v]) - firstArc.begin() - 1;
+		v = u;
+	}
+
+	if (v != NONE) {
+		if (compressed[source] == NONE) {
+			// Primeiro troço: da origem até à ponta da sua cadeia
+			auto &ch = chains[chainOf[source]];
+			size_t end = seedBackward[v] ? 0 : ch.seq.size() - 1;
+			walkChain(ch, posOf[source], end);
+		}
+		else
+			seq.push_back(source);
+	}
+	if (seq.empty() || seq.back() != source)
+		seq.push_back(source);
+
+	reverse(seq.begin(), seq.end());
+	reverse(ids.begin(), ids.end());
+	for (auto i : seq)
+		nodes.push_back(graph.getVertex(i)->getInfo());
+	edgeIDs = ids;
+	return true;
+}
+
+template <class T, class Alloc>
+vector<T> ChainCompressedGraph<T, Alloc>::getPath(const T &dest) const {
+	vector<T> nodes;
+	vector<int> edgeIDs;
+	getPath(dest, nodes, edgeIDs);
+	return nodes;
+}
+
+#endif /* CHAINCOMPRESSION_H_ */
@@ -0,0 +1,44 @@
+#ifndef COORDINATESTORE_H
+#define COORDINATESTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Point coordinates as structure of arrays (x[] and y[] apart from any ids),
+ * with batch kernels that process several points per instruction
+ * (AVX: 4 doubles, SSE2: 2, otherwise one at a time).
+ *
+ * Index i is whatever the caller decides (usually the vertex index).
+ */
+class CoordinateStore
+{
+public:
+	size_t add(double x, double y);
+	void set(size_t i, double x, double y);
+	void disable(size_t i);		// never returned by argmin again
+	void reserve(size_t n);
+	void clear();
+
+	size_t size() const { return xs.size(); }
+	double x(size_t i) const { return xs[i]; }
+	double y(size_t i) const { return ys[i]; }
+	double distance(size_t i, double px, double py) const;
+
+	// out[i] = squared distance from (px, py) to point first + i
+	void squaredDistances(double px, double py, size_t first, size_t count, double *out) const;
+	// out[i] = distance from (px, py) to every point
+	void distances(double px, double py, double *out) const;
+	// out[k] = distance between points a[k] and b[k]
+	void pairDistances(const uint32_t *a, const uint32_t *b, size_t count, double *out) const;
+	// closest point to (px, py) other than "exclude"; size() if none
+	size_t argmin(double px, double py, size_t exclude, double &squaredDistance) const;
+
+	static const char *kernelName();
+
+private:
+	std::vector<double> xs, ys;
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * DistanceField.h
+ * Full single source distances over vertex indices, kept in the caller's
+ * arrays instead of the Vertex dist/path fields, so that several searches
+ * can run at once on the same graph. Also the hubs x vertices matrix built
+ * from them (see DistanceMatrix).
+ */
+
+#ifndef DISTANCEFIELD_H_
+#define DISTANCEFIELD_H_
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include "Graph.h"
+#include "DistanceMatrix.h"
+
+/*
+ * Dijkstra from the vertex with index "source"; backward follows ingoing
+ * edges (distances to the source). parent, if given, gets the tree.
+ */
+template <class T, class Alloc>
+void distanceField(const Graph<T, Alloc> &graph, unsigned source, bool backward, vector<double> &dist, vector<uint32_t> *parent) {
+	typedef pair<double, uint32_t> Entry;
+	unsigned n = graph.getNumVertex();
+	dist.assign(n, INF);
+	if (parent != nullptr)
+		parent->assign(n, UINT32_MAX);
+	priority_queue<Entry, vector<Entry>, greater<Entry>> q;
+	dist[source] = 0;
+	q.push({ 0, source });
+	while (!q.empty()) {
+		auto top = q.top();
+		q.pop();
+		uint32_t v = top.second;
+		if (top.first > dist[v])
+			continue;
+		auto relax = [&](uint32_t w, double weight) {
+			if (dist[v] + weight < dist[w]) {
+				dist[w] = dist[v] + weight;
+				if (parent != nullptr)
+					(*parent)[w] = v;
+				q.push({ dist[w], w });
+			}
+		};
+		auto vertex = graph.getVertex(v);
+		if (backward)
+			for (auto &r : vertex->getIngoing())
+				relax(r.getOrig(), graph.getEdge(r).getWeight());
+		else
+			for (auto &e : vertex->getOutgoing())
+				relax(e.getDest(), e.getWeight());
+	}
+}
+
+/*
+ * Identifies a graph (vertex ids in index order, edges and their weights),
+ * so that a saved matrix is only reused with the same graph.
+ */
+template <class T, class Alloc>
+uint64_t graphFingerprint(const Graph<T, Alloc> &graph) {
+	uint64_t h = 1469598103934665603ull;	// FNV-1a
+	auto mix = [&h](uint64_t x) {
+		for (int i = 0; i < 8; i++) {
+			h ^= (x >> (8 * i)) & 0xff;
+			h *= 1099511628211ull;
+		}
+	};
+	mix(graph.getNumVertex());
+	for (int i = 0; i < graph.getNumVertex(); i++) {
+		auto v = graph.getVertex(i);
+		mix((uint32_t)v->getInfo().id);
+		for (auto &e : v->getOutgoing()) {
+			mix((uint64_t)e.getDest() << 32 | (uint32_t)e.getEdgeID());
+			double weight = e.getWeight();
+			uint64_t bits;
+			memcpy(&bits, &weight, sizeof(bits));
+			mix(bits);
+		}
+	}
+	return h;
+}
+
+/*
+ * Distances from every hub to every vertex, one row per hub, computed on
+ * "threads" threads (0: one per core). Hubs not in the graph get an
+ * UNREACHABLE row.
+ */
+template <class T, class Alloc>
+DistanceMatrix hubDistances(const Graph<T, Alloc> &graph, const vector<T> &hubs, unsigned threads = 0) {
+	unsigned n = graph.getNumVertex();
+	DistanceMatrix matrix(hubs.size(), n, graphFingerprint(graph));
+	vector<int> rows;
+	for (unsigned h = 0; h < hubs.size(); h++) {
+		auto v = graph.findVertex(hubs[h]);
+		rows.push_back(v == nullptr ? -1 : (int)v->getIndex());
+		matrix.setHubID(h, hubs[h].id);
+	}
+	if (threads == 0)
+		threads = max(1u, thread::hardware_concurrency());
+
+	atomic<unsigned> next(0);
+	auto worker = [&]() {
+		vector<double> dist;
+		for (unsigned h; (h = next++) < hubs.size(); ) {
+			float *row = matrix.writableRow(h);
+			if (rows[h] < 0) {
+				fill(row, row + n, DistanceMatrix::UNREACHABLE);
+				continue;
+			}
+			distanceField(graph, rows[h], false, dist, nullptr);
+			for (unsigned v = 0; v < n; v++)
+				row[v] = (dist[v] == INF) ? DistanceMatrix::UNREACHABLE : (float)dist[v];
+		}
+	};
+	vector<thread> pool;
+	for (unsigned t = 1; t < min<size_t>(threads, hubs.size()); t++)
+		pool.emplace_back(worker);
+	worker();
+	for (auto &t : pool)
+		t.join();
+	return matrix;
+}
+
+#endif /* DISTANCEFIELD_H_ */
@@ -0,0 +1,70 @@
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * hubs x vertices matrix of distances (float, one row per hub), as built
+ * by hubDistances (DistanceField.h).
+ *
+ * save() writes a small header, the hub ids and the rows; load() maps the
+ * file into memory (linux) or reads it, after checking that it belongs to
+ * the same graph (fingerprint).
+ */
+class DistanceMatrix
+{
+public:
+	static constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+
+	DistanceMatrix() = default;
+	DistanceMatrix(unsigned hubs, unsigned vertices, uint64_t fingerprint);
+	DistanceMatrix(DistanceMatrix &&other);
+	DistanceMatrix &operator=(DistanceMatrix &&other);
+	DistanceMatrix(const DistanceMatrix &) = delete;
+	DistanceMatrix &operator=(const DistanceMatrix &) = delete;
+	~DistanceMatrix();
+
+	unsigned getNumHubs() const { return hubs; }
+	unsigned getNumVertices() const { return vertices; }
+	uint64_t getFingerprint() const { return fingerprint; }
+	bool isMapped() const { return mapped != nullptr; }
+
+	int getHubID(unsigned hub) const { return hubIDs[hub]; }
+	void setHubID(unsigned hub, int id) { hubIDs[hub] = id; }
+	int findHub(int id) const;
+
+	const float *row(unsigned hub) const { return data + (size_t)hub * vertices; }
+	float *writableRow(unsigned hub);
+	float at(unsigned hub, unsigned vertex) const { return row(hub)[vertex]; }
+
+	bool save(const std::string &path) const;
+	bool load(const std::string &path, uint64_t expectedFingerprint);
+
+private:
+	struct FileHeader
+	{
+		char magic[4];			// "HUBD"
+		uint32_t version;
+		uint32_t hubs;
+		uint32_t vertices;
+		uint64_t fingerprint;
+		uint32_t reserved[10];	// header padded to 64 bytes
+	};
+
+	unsigned hubs = 0, vertices = 0;
+	uint64_t fingerprint = 0;
+	std::vector<int> hubIDs;
+	std::vector<float> owned;		// rows, when built or read
+	void *mapped = nullptr;			// whole file, when mapped
+	size_t mappedSize = 0;
+	float *data = nullptr;
+
+	void release();
+	void unmap();
+};
+
+#endif
@@ -0,0 +1,273 @@
+/*
+ * DynamicShortestPaths.h
+ * Single source shortest path tree kept up to date under edge insertions,
+ * deletions and weight changes (Ramalingam-Reps style repair).
+ *
+ * The tree is stored apart from the Vertex dist/path fields, so regular
+ * dijkstraShortestPath calls on the same graph do not invalidate it.
+ */
+
+#ifndef DYNAMICSHORTESTPATHS_H_
+#define DYNAMICSHORTESTPATHS_H_
+
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include "Graph.h"
+
+template <class T>
+class DynamicShortestPaths {
+	struct Label {
+		double dist = INF;
+		Vertex<T> *parent = nullptr;
+		bool affected = false;    // auxiliary field (deletion repair)
+	};
+	typedef pair<double, Vertex<T> *> QueueEntry;
+	typedef priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry>> MinQueue;
+
+	Graph<T> &graph;
+	Vertex<T> *source;
+	unordered_map<const Vertex<T> *, Label> labels;
+
+	Label &label(const Vertex<T> *v);
+	unsigned propagate(MinQueue &q, bool onlyAffected);
+	unsigned repairIncrease(Vertex<T> *u, Vertex<T> *v);
+	unsigned repairDecrease(Vertex<T> *u, Vertex<T> *v, double w);
+
+public:
+	DynamicShortestPaths(Graph<T> &graph, const T &source);
+	void recompute();
+
+	// Graph updates followed by a local repair of the tree.
+	// Each returns the number of vertices whose distance or parent changed.
+	// Weights are rounded to float, as the graph stores them.
+	unsigned insertEdge(const T &sourc, const T &dest, double w, int edgeID);
+	unsigned removeEdge(const T &sourc, const T &dest);
+	unsigned updateEdgeWeight(const T &sourc, const T &dest, double w);
+
+	double getDist(const T &dest) const;
+	vector<T> getPath(const T &dest) const;
+};
+
+template <class T>
+DynamicShortestPaths<T>::DynamicShortestPaths(Graph<T> &graph, const T &source) : graph(graph) {
+	this->source = graph.findVertex(source);
+	recompute();
+}
+
+template <class T>
+typename DynamicShortestPaths<T>::Label &DynamicShortestPaths<T>::label(const Vertex<T> *v) {
+	return labels[v];
+}
+
+/*
+ * Full recomputation (plain Dijkstra with lazy deletion) of the tree.
+ */
+template <class T>
+void DynamicShortestPaths<T>::recompute() {
+	labels.clear();
+	labels.reserve(graph.getNumVertex());
+	if (source == nullptr)
+		return;
+	MinQueue q;
+	label(source).dist = 0;
+	q.push({0, source});
+	propagate(q, false);
+}
+
+/*
+ * Dijkstra loop shared by the full computation and the repairs.
+ * With onlyAffected, edges into vertices that kept their label are ignored.
+ * Returns the number of labels improved.
+ */
+template <class T>
+unsigned DynamicShortestPaths<T>::propagate(MinQueue &q, bool onlyAffected) {
+	unsigned updated = 0;
+	while (!q.empty()) {
+		auto top = q.top();
+		q.pop();
+		auto v = top.second;
+		double dv = label(v).dist;
+		if (top.first > dv)
+			continue; // stale entry
+		for (auto &e : v->getOutgoing()) {
+			auto w = graph.getVertex(e.getDest());
+			Label &lw = label(w);
+			if (onlyAffected && !lw.affected)
+				continue;
+			if (dv + e.getWeight() < lw.dist) {
+				lw.dist = dv + e.getWeight();
+				lw.parent = v;
+				q.push({lw.dist, w});
+				updated++;
+			}
+		}
+	}
+	return updated;
+}
+
+/*
+ * Edge (u, v) became cheaper or was inserted: only vertices that improve
+ * are visited.
+ */
+template <class T>
+unsigned DynamicShortestPaths<T>::repairDecrease(Vertex<T> *u, Vertex<T> *v, double w) {
+	Label &lu = label(u);
+	Label &lv = label(v);
+	if (lu.dist == INF || lu.dist + w >= lv.dist)
+		return 0;
+	lv.dist = lu.dist + w;
+	lv.parent = u;
+	MinQueue q;
+	q.push({lv.dist, v});
+	return 1 + propagate(q, false);
+}
+
+/*
+ * Edge (u, v) became more expensive or was removed.
+ * Phase 1 walks the subtree of v, in increasing distance order, and marks as
+ * affected the vertices with no alternative parent of equal distance
+ * (a strictly closer in-neighbour that keeps its own label).
+ * Phase 2 gives the affected vertices their best distance through
+ * unaffected in-neighbours and runs Dijkstra restricted to them.
+ */
+template <class T>
+unsigned DynamicShortestPaths<T>::repairIncrease(Vertex<T> *u, Vertex<T> *v) {
+	if (label(v).parent != u)
+		return 0; // not a tree edge, the tree is still valid
+
+	vector<Vertex<T> *> affected;
+	unsigned reparented = 0;
+	MinQueue candidates;
+	unordered_map<const Vertex<T> *, bool> pending;
+	candidates.push({label(v).dist, v});
+	pending[v] = true;
+
+	while (!candidates.empty()) {
+		auto x = candidates.top().second;
+		candidates.pop();
+		Label &lx = label(x);
+		pending[x] = false;
+
+		Vertex<T> *alternative = nullptr;
+		for (auto &r : x->getIngoing()) {
+			auto p = graph.getVertex(r.getOrig());
+			double w = graph.getEdge(r).getWeight();
+			Label &lp = label(p);
+			// zero weight edges could point back into the subtree of x
+			if (lp.affected || pending[p] || lp.dist == INF || w <= 0)
+				continue;
+			if (lp.dist + w == lx.dist) {
+				alternative = p;
+				break;
+			}
+		}
+		if (alternative != nullptr) {
+			lx.parent = alternative;
+			reparented++;
+			continue;
+		}
+
+		lx.affected = true;
+		affected.push_back(x);
+		for (auto &e : x->getOutgoing()) {
+			auto y = graph.getVertex(e.getDest());
+			Label &ly = label(y);
+			if (ly.parent == x && !ly.affected && !pending[y]) {
+				pending[y] = true;
+				candidates.push({ly.dist, y});
+			}
+		}
+	}
+
+	MinQueue q;
+	for (auto x : affected) {
+		Label &lx = label(x);
+		lx.dist = INF;
+		lx.parent = nullptr;
+		for (auto &r : x->getIngoing()) {
+			auto p = graph.getVertex(r.getOrig());
+			double w = graph.getEdge(r).getWeight();
+			Label &lp = label(p);
+			if (lp.affected || lp.dist == INF)
+				continue;
+			if (lp.dist + w < lx.dist) {
+				lx.dist = lp.dist + w;
+				lx.parent = p;
+			}
+		}
+		if (lx.dist != INF)
+			q.push({lx.dist, x});
+	}
+	propagate(q, true);
+
+	for (auto x : affected)
+		label(x).affected = false;
+	return affected.size() + reparented;
+}
+
+template <class T>
+unsigned DynamicShortestPaths<T>::insertEdge(const T &sourc, const T &dest, double w, int edgeID) {
+	w = (float)w; // the weight the edge will hold
+	if (!graph.addEdge(sourc, dest, w, edgeID))
+		return 0;
+	return repairDecrease(graph.findVertex(sourc), graph.findVertex(dest), w);
+}
+
+template <class T>
+unsigned DynamicShortestPaths<T>::removeEdge(const T &sourc, const T &dest) {
+	if (!graph.removeEdge(sourc, dest))
+		return 0;
+	return repairIncrease(graph.findVertex(sourc), graph.findVertex(dest));
+}
+
+template <class T>
+unsigned DynamicShortestPaths<T>::updateEdgeWeight(const T &sourc, const T &dest, double w) {
+	w = (float)w; // the weight the edge will hold, compared with the stored one
+	auto u = graph.findVertex(sourc);
+	auto v = graph.findVertex(dest);
+	if (u == nullptr || v == nullptr)
+		return 0;
+	double old = INF;
+	for (auto &e : u->getOutgoing())
+		if (e.getDest() == v->getIndex()) {
+			old = e.getWeight();
+			break;
+		}
+	if (old == INF || !graph.updateEdgeWeight(sourc, dest, w))
+		return 0;
+	if (w < old)
+		return repairDecrease(u, v, w);
+	if (w > old)
+		return repairIncrease(u, v);
+	return 0;
+}
+
+template <class T>
+double DynamicShortestPaths<T>::getDist(const T &dest) const {
+	auto v = graph.findVertex(dest);
+	auto it = labels.find(v);
+	if (v == nullptr || it == labels.end())
+		return INF;
+	return it->second.dist;
+}
+
+template <class T>
+vector<T> DynamicShortestPaths<T>::getPath(const T &dest) const {
+	vector<T> res;
+	auto v = graph.findVertex(dest);
+	auto it = labels.find(v);
+	if (v == nullptr || it == labels.end() || it->second.dist == INF)
+		return res;
+	while (v != nullptr) {
+		res.push_back(v->getInfo());
+		it = labels.find(v);
+		v = (it == labels.end()) ? nullptr : it->second.parent;
+	}
+	reverse(res.begin(), res.end());
+	return res;
+}
+
+#endif /* DYNAMICSHORTESTPATHS_H_ */
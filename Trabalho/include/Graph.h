@@ -8,13 +8,18 @@
 #include <queue>
 #include <limits>
 #include <algorithm>
+#include <functional>
 #include <unordered_set>
+#include <cstdint>
 #include "MutablePriorityQueue.h"
+#include "SearchStats.h"
+#include "GraphAllocation.h"
 
 using namespace std;
 
 template <class T> class Edge;
-template <class T> class Graph;
+template <class T> class EdgeRef;
+template <class T, class Alloc = ArenaPolicy> class Graph;
 template <class T> class Vertex;
 
 #define INF std::numeric_limits<double>::max()
@@ -24,63 +29,40 @@ template <class T> class Vertex;
 template <class T>
 class Vertex {
 	T info;                // contents
-	vector<Edge<T> > outgoing;  // outgoing edges
-	vector<Edge<T> > ingoing;  // outgoing edges
+	pmr::vector<Edge<T> > outgoing;  // outgoing edges
+	pmr::vector<EdgeRef<T> > ingoing;  // ingoing edges (references to outgoing edges of other vertices)
+	uint32_t index = 0;    // position in the graph's vertex set
 	bool visited;          // auxiliary field
 	double dist = 0;
 	Vertex<T> *path = nullptr;
 	int queueIndex = 0; 		// required by MutablePriorityQueue
 
-	void addOutEdge(Vertex<T> *dest, double w, int edgeID);
-	void addInEdge(Vertex<T> *orig, double w, int edgeID);
-
-
 public:
-	Vertex(T in);
+	Vertex(T in, pmr::memory_resource *res = pmr::get_default_resource());
 	bool operator<(Vertex<T> & vertex) const; // // required by MutablePriorityQueue
 	T getInfo() const;
 	double getDist() const;
 	Vertex *getPath() const;
-	const vector<Edge<T>>& getOutgoing() const;
-	const vector<Edge<T>>& getIngoing() const;
-	bool removeEdgeTo(Vertex<T> *d);
-	friend class Graph<T>;
+	unsigned getIndex() const;
+	const pmr::vector<Edge<T>>& getOutgoing() const;
+	const pmr::vector<EdgeRef<T>>& getIngoing() const;
+	void reserveEdges(size_t out, size_t in);
+	template <class, class> friend class Graph;
 	friend class MutablePriorityQueue<Vertex<T>>;
 };
 
 
 template <class T>
-Vertex<T>::Vertex(T in): info(in) {}
-
-/*
- * Auxiliary function to add an outgoing edge to a vertex (this),
- * with a given destination vertex (d) and edge weight (w).
- */
-template <class T>
-void Vertex<T>::addOutEdge(Vertex<T> *d, double w, int edgeID) {
-	outgoing.push_back(Edge<T>(this, d, w, edgeID));
-}
-
-template <class T>
-void Vertex<T>::addInEdge(Vertex<T> *o, double w, int edgeID) {
-	ingoing.push_back(Edge<T>(o, this, w, edgeID));
-}
+Vertex<T>::Vertex(T in, pmr::memory_resource *res): info(in), outgoing(res), ingoing(res) {}
 
 /*
- * Auxiliary function to remove an outgoing edge (with a given destination (d))
- * from a vertex (this).
- * Returns true if successful, and false if such edge does not exist.
+ * Reserves room for the given number of outgoing and ingoing edges,
+ * so that loading a graph with known degrees does not reallocate.
  */
 template <class T>
-bool Vertex<T>::removeEdgeTo(Vertex<T> *d) {
-	for (auto it = outgoing.begin(); it != outgoing.end(); it++)
-	{
-		if (it->dest  == d) {
-			outgoing.erase(it);
-			return true;
-		}
-	}
-	return false;
+void Vertex<T>::reserveEdges(size_t out, size_t in) {
+	outgoing.reserve(out);
+	ingoing.reserve(in);
 }
 
 template <class T>
@@ -104,49 +86,48 @@ Vertex<T> *Vertex<T>::getPath() const {
 }
 
 template <class T>
-const vector<Edge<T>>& Vertex<T>::getOutgoing() const{
+unsigned Vertex<T>::getIndex() const {
+	return this->index;
+}
+
+template <class T>
+const pmr::vector<Edge<T>>& Vertex<T>::getOutgoing() const{
 	return this->outgoing;
 }
 
 template <class T>
-const vector<Edge<T>>& Vertex<T>::getIngoing() const{
+const pmr::vector<EdgeRef<T>>& Vertex<T>::getIngoing() const{
 	return this->ingoing;
 }
 
 
 /********************** Edge  ****************************/
 
+/*
+ * Outgoing edge, 12 bytes: destination as a 32-bit vertex index
+ * (see Graph::getVertex), weight as float and the shared edge ID.
+ * The origin is the vertex that owns the edge.
+ */
 template <class T>
 class Edge {
-	Vertex<T> *orig; 	// Fp07
-	Vertex<T> *dest;      // destination vertex
-	double weight;         // edge weight
-	int edgeID;
-
-	bool selected; // Fp07
+	uint32_t dest;      // index of the destination vertex
+	float weight;       // edge weight
+	int32_t edgeID;
 
 public:
-	Edge(Vertex<T> *o, Vertex<T> *d, double w, int edgeID);
-	friend class Graph<T>;
-	friend class Vertex<T>;
+	Edge(uint32_t d, double w, int edgeID);
+	template <class, class> friend class Graph;
 
-	// Fp07
-	Vertex<T> * getOrig() const;
-	Vertex<T> * getDest() const;
+	unsigned getDest() const;
 	double getWeight() const;
-	double getEdgeID() const;
+	int getEdgeID() const;
 };
 
 template <class T>
-Edge<T>::Edge(Vertex<T> *o, Vertex<T> *d, double w, int edgeID): orig(o), dest(d), weight(w), edgeID(edgeID) {}
-
-template <class T>
-Vertex<T> * Edge<T>::getOrig() const {
-	return orig;
-}
+Edge<T>::Edge(uint32_t d, double w, int edgeID): dest(d), weight((float)w), edgeID(edgeID) {}
 
 template <class T>
-Vertex<T> * Edge<T>::getDest() const {
+unsigned Edge<T>::getDest() const {
 	return dest;
 }
 
@@ -156,17 +137,52 @@ double Edge<T>::getWeight() const {
 }
 
 template <class T>
-double Edge<T>::getEdgeID() const {
+int Edge<T>::getEdgeID() const {
 	return edgeID;
 }
 
+/*
+ * Ingoing edge, 8 bytes: refers to outgoing[slot] of the vertex with index orig
+ * instead of keeping a second copy of the edge (see Graph::getEdge).
+ */
+template <class T>
+class EdgeRef {
+	uint32_t orig;      // index of the origin vertex
+	uint32_t slot;      // position in the origin's outgoing edges
 
-/*************************** Graph  **************************/
+public:
+	EdgeRef(uint32_t o, uint32_t s);
+	template <class, class> friend class Graph;
+
+	unsigned getOrig() const;
+	unsigned getSlot() const;
+};
+
+template <class T>
+EdgeRef<T>::EdgeRef(uint32_t o, uint32_t s): orig(o), slot(s) {}
+
+template <class T>
+unsigned EdgeRef<T>::getOrig() const {
+	return orig;
+}
 
 template <class T>
+unsigned EdgeRef<T>::getSlot() const {
+	return slot;
+}
+
+
+/*************************** Graph  **************************/
+
+template <class T, class Alloc>
 class Graph {
+	Alloc alloc;                      // where vertices and edge lists live
 	vector<Vertex<T> *> vertexSet;    // vertex set
 
+	Vertex<T> *createVertex(const T &in);
+	void destroyVertex(Vertex<T> *v);
+	void removeOutEdge(Vertex<T> *v, uint32_t slot);
+
 	// Fp05
 	Vertex<T> * initSingleSource(const T &orig);
 	bool relax(Vertex<T> *v, Vertex<T> *w, double weight);
@@ -174,17 +190,28 @@ class Graph {
 	int **P = nullptr;   // path
 	int findVertexIdx(const T &in) const;
 
+	mutable SearchStats<GRAPH_STATS_ENABLED> stats; // compiled out unless GRAPH_STATS
+
 
 public:
+	Graph() = default;
+	Graph(const Graph &) = delete;
+	Graph &operator=(const Graph &) = delete;
+	void reserve(size_t vertices, size_t edges);
+
 	Vertex<T> *findVertex(const T &in) const;
 	Vertex<T> *findVertex(const int &in) const;
 	bool addVertex(const T &in);
 	bool removeVertex(const T &in);
 	bool addEdge(const T &sourc, const T &dest, double w, int edgeID);
 	bool removeEdge(const T &sourc, const T &dest);
+	bool updateEdgeWeight(const T &sourc, const T &dest, double w);
 	int getNumVertex() const;
 	vector<Vertex<T> *> getVertexSet() const;
+	Vertex<T> *getVertex(unsigned idx) const;
+	const Edge<T> &getEdge(const EdgeRef<T> &ref) const;
 	int getEdgeID(T n1, T n2) const;
+	void renumber(const vector<uint32_t> &order);
 
 	vector<T> bfs(const T & source) const;
 
@@ -195,6 +222,16 @@ public:
 	vector<T> getPath(const T &dest) const;
 	double getPathDistance(const T &dest) const;
 
+	// Time-dependent single source (travelTime(edge, t) must respect FIFO)
+	template <class Cost>
+	void timeDependentShortestPath(const T &s, double departure, Cost travelTime);
+	template <class Cost, class Heuristic>
+	void timeDependentAStar(const T &s, const T &d, double departure, Cost travelTime, Heuristic h);
+
+	// Point to point A* with the edge weights (h must be admissible)
+	template <class Heuristic>
+	void aStarShortestPath(const T &s, const T &d, Heuristic h);
+
 	// Fp05 - all pairs
 	void floydWarshallShortestPath();
 	vector<T> getfloydWarshallPath(const T &origin, const T &dest) const;
@@ -203,29 +240,58 @@ public:
 	// Fp07 - minimum spanning tree
 	vector<Vertex<T>*> calculatePrim();
 	vector<Vertex<T>*> calculateKruskal();
+
+	// Instrumentation (see SearchStats.h)
+	const SearchCounters& getStats() const;
+	void resetStats();
 };
 
 
-template <class T>
-int Graph<T>::getNumVertex() const {
+template <class T, class Alloc>
+int Graph<T, Alloc>::getNumVertex() const {
 	return vertexSet.size();
 }
 
-template <class T>
-vector<Vertex<T> *> Graph<T>::getVertexSet() const {
+template <class T, class Alloc>
+vector<Vertex<T> *> Graph<T, Alloc>::getVertexSet() const {
 	return vertexSet;
 }
 
-template <class T>
-int Graph<T>::getEdgeID(T n1, T n2) const {
+/*
+ * Vertex with a given index (as stored in Edge::dest and EdgeRef::orig).
+ */
+template <class T, class Alloc>
+Vertex<T> * Graph<T, Alloc>::getVertex(unsigned idx) const {
+	return vertexSet[idx];
+}
+
+/*
+ * Outgoing edge an ingoing reference points to.
+ */
+template <class T, class Alloc>
+const Edge<T> & Graph<T, Alloc>::getEdge(const EdgeRef<T> &ref) const {
+	return vertexSet[ref.orig]->outgoing[ref.slot];
+}
+
+template <class T, class Alloc>
+const SearchCounters& Graph<T, Alloc>::getStats() const {
+	return stats.get();
+}
+
+template <class T, class Alloc>
+void Graph<T, Alloc>::resetStats() {
+	stats.reset();
+}
+
+template <class T, class Alloc>
+int Graph<T, Alloc>::getEdgeID(T n1, T n2) const {
 	Vertex<T>* n1V = findVertex(n1);
-	Vertex<T>* n2V = findVertex(n1);
+	Vertex<T>* n2V = findVertex(n2);
 	if (n1V == nullptr || n2V == nullptr)
 		return -1;
 	
-	T other;
 	for(auto& e : n1V->getOutgoing())
-		if(e.dest->getInfo().id == n2.id)
+		if(e.dest == n2V->index)
 			return e.edgeID;
 	return -1;
 }
@@ -233,16 +299,16 @@ int Graph<T>::getEdgeID(T n1, T n2) const {
 /*
  * Auxiliary function to find a vertex with a given content.
  */
-template <class T>
-Vertex<T> * Graph<T>::findVertex(const T &in) const {
+template <class T, class Alloc>
+Vertex<T> * Graph<T, Alloc>::findVertex(const T &in) const {
 	for (auto v : vertexSet)
 		if (v->info == in)
 			return v;
 	return nullptr;
 }
 
-template <class T>
-Vertex<T> * Graph<T>::findVertex(const int &in) const {
+template <class T, class Alloc>
+Vertex<T> * Graph<T, Alloc>::findVertex(const int &in) const {
 	for (auto v : vertexSet)
 		if (v->info.id == in)
 			return v;
@@ -254,8 +320,8 @@ Vertex<T> * Graph<T>::findVertex(const int &in) const {
 /*
  * Finds the index of the vertex with a given content.
  */
-template <class T>
-int Graph<T>::findVertexIdx(const T &in) const {
+template <class T, class Alloc>
+int Graph<T, Alloc>::findVertexIdx(const T &in) const {
 	for (unsigned i = 0; i < vertexSet.size(); i++)
 		if (vertexSet[i]->info == in)
 			return i;
@@ -265,31 +331,107 @@ int Graph<T>::findVertexIdx(const T &in) const {
  *  Adds a vertex with a given content or info (in) to a graph (this).
  *  Returns true if successful, and false if a vertex with that content already exists.
  */
-template <class T>
-bool Graph<T>::addVertex(const T &in) {
+template <class T, class Alloc>
+bool Graph<T, Alloc>::addVertex(const T &in) {
 	if (findVertex(in) != nullptr)
 		return false;
-	vertexSet.push_back(new Vertex<T>(in));
+	auto v = createVertex(in);
+	v->index = vertexSet.size();
+	vertexSet.push_back(v);
 	return true;
 }
 
+/*
+ * Vertices are built in memory handed out by the allocation policy.
+ */
+template <class T, class Alloc>
+Vertex<T> * Graph<T, Alloc>::createVertex(const T &in) {
+	pmr::memory_resource *res = alloc.resource();
+	void *mem = res->allocate(sizeof(Vertex<T>), alignof(Vertex<T>));
+	return new (mem) Vertex<T>(in, res);
+}
+
+template <class T, class Alloc>
+void Graph<T, Alloc>::destroyVertex(Vertex<T> *v) {
+	v->~Vertex<T>();
+	if (!Alloc::bulkRelease)
+		alloc.resource()->deallocate(v, sizeof(Vertex<T>), alignof(Vertex<T>));
+}
+
+/*
+ * Prepares the graph for the given number of vertices and (directed) edges:
+ * the vertex set is reserved and, for arena policies, the first block is
+ * sized to hold every vertex and edge list.
+ * Must be called before any vertex is added.
+ */
+template <class T, class Alloc>
+void Graph<T, Alloc>::reserve(size_t vertices, size_t edges) {
+	if (!vertexSet.empty())
+		return;
+	vertexSet.reserve(vertices);
+	alloc.reserve(vertices * sizeof(Vertex<T>) + edges * (sizeof(Edge<T>) + sizeof(EdgeRef<T>)));
+}
+
 /*
  *  Removes a vertex with a given content (in) from a graph (this), and
  *  all outgoing and incoming edges.
  *  Returns true if successful, and false if such vertex does not exist.
  */
-template <class T>
-bool Graph<T>::removeVertex(const T &in) {
-	for (auto it = vertexSet.begin(); it != vertexSet.end(); it++)
-		if ((*it)->info  == in) {
-			auto v = *it;
-			vertexSet.erase(it);
-			for (auto u : vertexSet)
-				u->removeEdgeTo(v);
-			delete v;
-			return true;
+template <class T, class Alloc>
+bool Graph<T, Alloc>::removeVertex(const T &in) {
+	auto v = findVertex(in);
+	if (v == nullptr)
+		return false;
+
+	// Drop ingoing edges (from their origins) and then outgoing ones
+	while (!v->ingoing.empty()) {
+		auto ref = v->ingoing.back();
+		removeOutEdge(vertexSet[ref.orig], ref.slot);
+	}
+	while (!v->outgoing.empty())
+		removeOutEdge(v, v->outgoing.size() - 1);
+
+	// Close the gap in the vertex set; indices after it move down by one
+	uint32_t idx = v->index;
+	vertexSet.erase(vertexSet.begin() + idx);
+	for (uint32_t i = idx; i < vertexSet.size(); i++)
+		vertexSet[i]->index = i;
+	for (auto u : vertexSet) {
+		for (auto &e : u->outgoing)
+			if (e.dest > idx)
+				e.dest--;
+		for (auto &r : u->ingoing)
+			if (r.orig > idx)
+				r.orig--;
+	}
+	destroyVertex(v);
+	return true;
+}
+
+/*
+ * Removes outgoing[slot] of v and its ingoing reference. The last outgoing
+ * edge is moved into the freed slot, so only its reference has to be fixed.
+ */
+template <class T, class Alloc>
+void Graph<T, Alloc>::removeOutEdge(Vertex<T> *v, uint32_t slot) {
+	auto &in = vertexSet[v->outgoing[slot].dest]->ingoing;
+	for (auto it = in.begin(); it != in.end(); it++)
+		if (it->orig == v->index && it->slot == slot) {
+			*it = in.back();
+			in.pop_back();
+			break;
 		}
-	return false;
+
+	uint32_t last = v->outgoing.size() - 1;
+	if (slot != last) {
+		v->outgoing[slot] = v->outgoing[last];
+		for (auto &r : vertexSet[v->outgoing[slot].dest]->ingoing)
+			if (r.orig == v->index && r.slot == last) {
+				r.slot = slot;
+				break;
+			}
+	}
+	v->outgoing.pop_back();
 }
 
 /*
@@ -297,15 +439,14 @@ bool Graph<T>::removeVertex(const T &in) {
  * destination vertices and the edge weight (w).
  * Returns true if successful, and false if the source or destination vertex does not exist.
  */
-template <class T>
-bool Graph<T>::addEdge(const T &sourc, const T &dest, double w, int edgeID) {
+template <class T, class Alloc>
+bool Graph<T, Alloc>::addEdge(const T &sourc, const T &dest, double w, int edgeID) {
 	auto v1 = findVertex(sourc);
 	auto v2 = findVertex(dest);
 	if (v1 == nullptr || v2 == nullptr)
 		return false;
-	v1->addOutEdge(v2, w, edgeID);
-
-	v2->addInEdge(v1, w, edgeID);
+	v2->ingoing.push_back(EdgeRef<T>(v1->index, v1->outgoing.size()));
+	v1->outgoing.push_back(Edge<T>(v2->index, w, edgeID));
 	return true;
 }
 
@@ -314,13 +455,37 @@ bool Graph<T>::addEdge(const T &sourc, const T &dest, double w, int edgeID) {
  * The edge is identified by the source (sourc) and destination (dest) contents.
  * Returns true if successful, and false if such edge does not exist.
  */
-template <class T>
-bool Graph<T>::removeEdge(const T &sourc, const T &dest) {
+template <class T, class Alloc>
+bool Graph<T, Alloc>::removeEdge(const T &sourc, const T &dest) {
 	auto v1 = findVertex(sourc);
 	auto v2 = findVertex(dest);
 	if (v1 == NULL || v2 == NULL)
 		return false;
-	return v1->removeEdgeTo(v2);
+	for (uint32_t i = 0; i < v1->outgoing.size(); i++)
+		if (v1->outgoing[i].dest == v2->index) {
+			removeOutEdge(v1, i);
+			return true;
+		}
+	return false;
+}
+
+/*
+ * Changes the weight of an edge, identified by the source (sourc) and
+ * destination (dest) contents. Ingoing references see the change too.
+ * Returns true if successful, and false if such edge does not exist.
+ */
+template <class T, class Alloc>
+bool Graph<T, Alloc>::updateEdgeWeight(const T &sourc, const T &dest, double w) {
+	auto v1 = findVertex(sourc);
+	auto v2 = findVertex(dest);
+	if (v1 == nullptr || v2 == nullptr)
+		return false;
+	for (auto &e : v1->outgoing)
+		if (e.dest == v2->index) {
+			e.weight = w;
+			return true;
+		}
+	return false;
 }
 
 
@@ -330,25 +495,31 @@ bool Graph<T>::removeEdge(const T &sourc, const T &dest) {
  * Returns a vector with the contents of the vertices by dfs order.
  * Follows the algorithm described in theoretical classes.
  */
-template <class T>
-vector<T> Graph<T>::bfs(const T & source) const {
+template <class T, class Alloc>
+vector<T> Graph<T, Alloc>::bfs(const T & source) const {
 	vector<T> res;
 	auto s = findVertex(source);
 	if (s == NULL)
 		return res;
 	queue<Vertex<T> *> q;
+	stats.search(vertexSet.size() * sizeof(Vertex<T>));
 	for (auto v : vertexSet)
 		v->visited = false;
 	q.push(s);
+	stats.queueOp();
 	s->visited = true;
 	while (!q.empty()) {
 		auto v = q.front();
 		q.pop();
+		stats.queueOp();
+		stats.settle(sizeof(Vertex<T>));
 		res.push_back(v->info);
 		for (auto & e : v->getOutgoing()) {
-			auto w = e.dest;
+			auto w = vertexSet[e.dest];
+			stats.relax(!w->visited, sizeof(Edge<T>) + sizeof(Vertex<T>));
 		    if ( ! w->visited ) {
 				q.push(w);
+				stats.queueOp();
 				w->visited = true;
 		    }
 		}
@@ -364,8 +535,8 @@ vector<T> Graph<T>::bfs(const T & source) const {
  * Receives the content of the source vertex and returns a pointer to the source vertex.
  * Used by all single-source shortest path algorithms.
  */
-template<class T>
-Vertex<T> * Graph<T>::initSingleSource(const T &origin) {
+template<class T, class Alloc>
+Vertex<T> * Graph<T, Alloc>::initSingleSource(const T &origin) {
 	for(auto v : vertexSet) {
 		v->dist = INF;
 		v->path = nullptr;
@@ -380,8 +551,8 @@ Vertex<T> * Graph<T>::initSingleSource(const T &origin) {
  * Returns true if the target vertex was relaxed (dist, path).
  * Used by all single-source shortest path algorithms.
  */
-template<class T>
-inline bool Graph<T>::relax(Vertex<T> *v, Vertex<T> *w, double weight) {
+template<class T, class Alloc>
+inline bool Graph<T, Alloc>::relax(Vertex<T> *v, Vertex<T> *w, double weight) {
 	if (v->dist + weight < w->dist) {
 		w->dist = v->dist + weight;
 		w->path = v;
@@ -391,27 +562,115 @@ inline bool Graph<T>::relax(Vertex<T> *v, Vertex<T> *w, double weight) {
 		return false;
 }
 
-template<class T>
-void Graph<T>::dijkstraShortestPath(const T &origin) {
+template<class T, class Alloc>
+void Graph<T, Alloc>::dijkstraShortestPath(const T &origin) {
 	auto s = initSingleSource(origin);
+	stats.search(vertexSet.size() * sizeof(Vertex<T>));
 	MutablePriorityQueue<Vertex<T>> q;
 	q.insert(s);
+	stats.queueOp();
 	while( ! q.empty() ) {
 		auto v = q.extractMin();
-		for(auto e : v->outgoing) {
-			auto oldDist = e.dest->dist;
-			if (relax(v, e.dest, e.weight)) {
+		stats.queueOp();
+		stats.settle(sizeof(Vertex<T>));
+		for(auto &e : v->outgoing) {
+			auto w = vertexSet[e.dest];
+			auto oldDist = w->dist;
+			bool relaxed = relax(v, w, e.weight);
+			stats.relax(relaxed, sizeof(Edge<T>) + sizeof(Vertex<T>));
+			if (relaxed) {
 				if (oldDist == INF)
-					q.insert(e.dest);
+					q.insert(w);
 				else
-					q.decreaseKey(e.dest);
+					q.decreaseKey(w);
+				stats.queueOp();
 			}
 		}
 	}
 }
 
-template<class T>
-vector<T> Graph<T>::getPath(const T &dest) const{
+/*
+ * Dijkstra over time-dependent costs: the weight of an edge is the travel
+ * time when entering it at departure + dist of its origin.
+ * Label-setting is correct because the costs are FIFO.
+ * Afterwards dist holds the travel time from the source.
+ */
+template<class T, class Alloc>
+template<class Cost>
+void Graph<T, Alloc>::timeDependentShortestPath(const T &origin, double departure, Cost travelTime) {
+	auto s = initSingleSource(origin);
+	stats.search(vertexSet.size() * sizeof(Vertex<T>));
+	MutablePriorityQueue<Vertex<T>> q;
+	q.insert(s);
+	stats.queueOp();
+	while( ! q.empty() ) {
+		auto v = q.extractMin();
+		stats.queueOp();
+		stats.settle(sizeof(Vertex<T>));
+		for(auto &e : v->outgoing) {
+			auto w = vertexSet[e.dest];
+			auto oldDist = w->dist;
+			bool relaxed = relax(v, w, travelTime(e, departure + v->dist));
+			stats.relax(relaxed, sizeof(Edge<T>) + sizeof(Vertex<T>));
+			if (relaxed) {
+				if (oldDist == INF)
+					q.insert(w);
+				else
+					q.decreaseKey(w);
+				stats.queueOp();
+			}
+		}
+	}
+}
+
+/*
+ * Point to point variant guided by an admissible heuristic h(vertex)
+ * (lower bound of the travel time to the destination).
+ * Stops as soon as the destination is settled.
+ */
+template<class T, class Alloc>
+template<class Cost, class Heuristic>
+void Graph<T, Alloc>::timeDependentAStar(const T &origin, const T &dest, double departure, Cost travelTime, Heuristic h) {
+	typedef pair<double, Vertex<T> *> Entry;
+	auto s = initSingleSource(origin);
+	auto d = findVertex(dest);
+	stats.search(vertexSet.size() * sizeof(Vertex<T>));
+	priority_queue<Entry, vector<Entry>, greater<Entry>> q;
+	q.push({h(s), s});
+	stats.queueOp();
+	while( ! q.empty() ) {
+		auto top = q.top();
+		q.pop();
+		stats.queueOp();
+		auto v = top.second;
+		if (top.first > v->dist + h(v))
+			continue; // stale entry
+		stats.settle(sizeof(Vertex<T>));
+		if (v == d)
+			return;
+		for(auto &e : v->outgoing) {
+			auto w = vertexSet[e.dest];
+			bool relaxed = relax(v, w, travelTime(e, departure + v->dist));
+			stats.relax(relaxed, sizeof(Edge<T>) + sizeof(Vertex<T>));
+			if (relaxed) {
+				q.push({w->dist + h(w), w});
+				stats.queueOp();
+			}
+		}
+	}
+}
+
+/*
+ * Static weights are the constant travel time case of timeDependentAStar.
+ */
+template<class T, class Alloc>
+template<class Heuristic>
+void Graph<T, Alloc>::aStarShortestPath(const T &origin, const T &dest, Heuristic h) {
+	timeDependentAStar(origin, dest, 0, [](const Edge<T> &e, double) { return e.getWeight(); }, h);
+}
+
+template<class T, class Alloc>
+vector<T> Graph<T, Alloc>::getPath(const T &dest) const{
 	vector<T> res;
 	auto v = findVertex(dest);
 	if (v == nullptr || v->dist == INF) // missing or disconnected
@@ -422,8 +681,8 @@ vector<T> Graph<T>::getPath(const T &dest) const{
 	return res;
 }
 
-template<class T>
-double Graph<T>::getPathDistance(const T &dest) const{
+template<class T, class Alloc>
+double Graph<T, Alloc>::getPathDistance(const T &dest) const{
     int dist = 0;
     auto v = findVertex(dest);
     if (v == nullptr || v->dist == INF) // missing or disconnected
@@ -433,8 +692,8 @@ double Graph<T>::getPathDistance(const T &dest) const{
     return dist;
 }
 
-template<class T>
-void Graph<T>::unweightedShortestPath(const T &orig) {
+template<class T, class Alloc>
+void Graph<T, Alloc>::unweightedShortestPath(const T &orig) {
 	auto s = initSingleSource(orig);
 	queue< Vertex<T>* > q;
 	q.push(s);
@@ -442,21 +701,24 @@ void Graph<T>::unweightedShortestPath(const T &orig) {
 		auto v = q.front();
 		q.pop();
 		for(auto e: v->outgoing)
-			if (relax(v, e.dest, 1))
-				q.push(e.dest);
+			if (relax(v, vertexSet[e.dest], 1))
+				q.push(vertexSet[e.dest]);
 	}
 }
 
-template<class T>
-void Graph<T>::bellmanFordShortestPath(const T &orig) {
+template<class T, class Alloc>
+void Graph<T, Alloc>::bellmanFordShortestPath(const T &orig) {
 	initSingleSource(orig);
+	stats.search(vertexSet.size() * sizeof(Vertex<T>));
 	for (unsigned i = 1; i < vertexSet.size(); i++)
-		for (auto v: vertexSet)
+		for (auto v: vertexSet) {
+			stats.settle(sizeof(Vertex<T>));
 			for (auto e: v->outgoing)
-				relax(v, e.dest, e.weight);
+				stats.relax(relax(v, vertexSet[e.dest], e.weight), sizeof(Edge<T>) + sizeof(Vertex<T>));
+		}
 	for (auto v: vertexSet)
 		for (auto e: v->outgoing)
-			if (relax(v, e.dest, e.weight))
+			if (relax(v, vertexSet[e.dest], e.weight))
 				cout << "Negative cycle!" << endl;
 }
 
@@ -473,19 +735,72 @@ void deleteMatrix(T **m, int n) {
 	}
 }
 
-template <class T>
-Graph<T>::~Graph() {
+template <class T, class Alloc>
+Graph<T, Alloc>::~Graph() {
 	deleteMatrix(W, vertexSet.size());
 	deleteMatrix(P, vertexSet.size());
+	// With an arena policy the memory itself is released at once with "alloc"
+	for (auto v : vertexSet)
+		destroyVertex(v);
 }
 
-template<class T>
-void Graph<T>::floydWarshallShortestPath() {
+/*
+ * Renumbers the vertices: vertex order[i] becomes the vertex with index i.
+ * Vertices and edge lists are rebuilt, in the new order, in fresh memory from
+ * the allocation policy, so that an ordering with spatial locality also gives
+ * locality in memory. Contents (e.g. OSM ids) are kept.
+ * Invalidates every Vertex pointer obtained before the call.
+ */
+template<class T, class Alloc>
+void Graph<T, Alloc>::renumber(const vector<uint32_t> &order) {
+	unsigned n = vertexSet.size();
+	if (order.size() != n)
+		return;
+	vector<uint32_t> newIdx(n);
+	for (uint32_t i = 0; i < n; i++)
+		newIdx[order[i]] = i;
+
+	size_t edges = 0;
+	for (auto v : vertexSet)
+		edges += v->outgoing.size();
+
+	Alloc newAlloc;
+	newAlloc.reserve(n * sizeof(Vertex<T>) + edges * (sizeof(Edge<T>) + sizeof(EdgeRef<T>)));
+	pmr::memory_resource *res = newAlloc.resource();
+
+	vector<Vertex<T> *> newSet(n);
+	for (uint32_t i = 0; i < n; i++) {
+		auto old = vertexSet[order[i]];
+		void *mem = res->allocate(sizeof(Vertex<T>), alignof(Vertex<T>));
+		auto v = new (mem) Vertex<T>(old->info, res);
+		v->index = i;
+		v->reserveEdges(old->outgoing.size(), old->ingoing.size());
+		// outgoing order is kept, so ingoing slots stay valid
+		for (auto &e : old->outgoing)
+			v->outgoing.push_back(Edge<T>(newIdx[e.dest], e.weight, e.edgeID));
+		for (auto &r : old->ingoing)
+			v->ingoing.push_back(EdgeRef<T>(newIdx[r.orig], r.slot));
+		newSet[i] = v;
+	}
+
+	deleteMatrix(W, n);
+	deleteMatrix(P, n);
+	W = nullptr;
+	P = nullptr;
+	for (auto v : vertexSet)
+		destroyVertex(v);
+	vertexSet.swap(newSet);
+	alloc = std::move(newAlloc);
+}
+
+template<class T, class Alloc>
+void Graph<T, Alloc>::floydWarshallShortestPath() {
 	unsigned n = vertexSet.size();
 	deleteMatrix(W, n);
 	deleteMatrix(P, n);
 	W = new double *[n];
 	P = new int *[n];
+	stats.search((size_t)n * n * (sizeof(double) + sizeof(int)));
 	for (unsigned i = 0; i < n; i++) {
 		W[i] = new double[n];
 		P[i] = new int[n];
@@ -494,28 +809,31 @@ void Graph<T>::floydWarshallShortestPath() {
 			P[i][j] = -1;
 		}
 		for (auto e : vertexSet[i]->outgoing) {
-			int j = findVertexIdx(e.dest->info);
+			int j = e.dest;
 			W[i][j]  = e.weight;
 			P[i][j]  = i;
 		}
 	}
 
-	for(unsigned k = 0; k < n; k++)
+	for(unsigned k = 0; k < n; k++) {
+		stats.settle(sizeof(Vertex<T>));
 		for(unsigned i = 0; i < n; i++)
 			for(unsigned j = 0; j < n; j++) {
 				if(W[i][k] == INF || W[k][j] == INF)
 					continue; // avoid overflow
 				int val = W[i][k] + W[k][j];
+				stats.relax(val < W[i][j], 3 * sizeof(double));
 				if (val < W[i][j]) {
 					W[i][j] = val;
 					P[i][j] = P[k][j];
 				}
 			}
+	}
 }
 
 
-template<class T>
-vector<T> Graph<T>::getfloydWarshallPath(const T &orig, const T &dest) const{
+template<class T, class Alloc>
+vector<T> Graph<T, Alloc>::getfloydWarshallPath(const T &orig, const T &dest) const{
 	vector<T> res;
 	int i = findVertexIdx(orig);
 	int j = findVertexIdx(dest);
@@ -529,16 +847,16 @@ vector<T> Graph<T>::getfloydWarshallPath(const T &orig, const T &dest) const{
 
 /**************** Minimum Spanning Tree  ***************/
 
-template <class T>
-vector<Vertex<T>* > Graph<T>::calculatePrim() {
+template <class T, class Alloc>
+vector<Vertex<T>* > Graph<T, Alloc>::calculatePrim() {
 	// TODO
 	return vertexSet;
 }
 
 
 
-template <class T>
-vector<Vertex<T>*> Graph<T>::calculateKruskal() {
+template <class T, class Alloc>
+vector<Vertex<T>*> Graph<T, Alloc>::calculateKruskal() {
 	// TODO
 	return vertexSet;
 }
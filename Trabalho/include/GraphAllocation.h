@@ -0,0 +1,61 @@
+/*
+ * GraphAllocation.h
+ * Allocation policies for Graph<T, Alloc>.
+ *
+ * A policy hands out the memory_resource used for the vertices and their
+ * edge lists, and says whether that memory is released in one go when the
+ * graph is destroyed (bulkRelease) or object by object.
+ */
+
+#ifndef GRAPHALLOCATION_H_
+#define GRAPHALLOCATION_H_
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+/*
+ * One new/delete per vertex and per edge list (the original behaviour).
+ */
+class HeapPolicy {
+public:
+	static const bool bulkRelease = false;
+
+	std::pmr::memory_resource *resource() { return std::pmr::new_delete_resource(); }
+	void reserve(size_t) {}
+	size_t reserved() const { return 0; }
+};
+
+/*
+ * Vertices and edge lists are carved out of large contiguous blocks, in
+ * insertion order. Individual frees are no-ops; everything is returned at
+ * once when the graph goes away.
+ */
+class ArenaPolicy {
+	std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+	size_t initialSize = 0;
+	bool used = false;
+public:
+	static const bool bulkRelease = true;
+
+	ArenaPolicy() : arena(new std::pmr::monotonic_buffer_resource()) {}
+
+	std::pmr::memory_resource *resource() {
+		used = true;
+		return arena.get();
+	}
+
+	/*
+	 * Sets the size of the first block. Only has effect before anything
+	 * was allocated (i.e. right after the graph was created).
+	 */
+	void reserve(size_t bytes) {
+		if (used || bytes == 0)
+			return;
+		initialSize = bytes;
+		arena.reset(new std::pmr::monotonic_buffer_resource(bytes));
+	}
+	size_t reserved() const { return initialSize; }
+};
+
+#endif /* GRAPHALLOCATION_H_ */
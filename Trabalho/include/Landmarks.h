@@ -0,0 +1,248 @@
+/*
+ * Landmarks.h
+ * ALT preprocessing: k landmarks with the distances from (outgoing edges)
+ * and to (ingoing edges) every vertex, and the A* lower bound they give
+ * through the triangle inequality.
+ *
+ * Distances are stored vertex by vertex as 32-bit multiples of a fixed
+ * resolution (rounded down); the bounds subtract one step, so they stay
+ * admissible.
+ */
+
+#ifndef LANDMARKS_H_
+#define LANDMARKS_H_
+
+#include <vector>
+#include <queue>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include "Graph.h"
+#include "DistanceField.h"
+
+template <class T, class Alloc = ArenaPolicy>
+class Landmarks {
+public:
+	enum Strategy { FARTHEST, AVOID };
+
+	Landmarks(Graph<T, Alloc> &graph, unsigned k, Strategy strategy = AVOID, unsigned threads = 0, unsigned seed = 0);
+
+	unsigned getNumLandmarks() const { return landmarks.size(); }
+	const vector<uint32_t> &getLandmarks() const { return landmarks; }
+	double getResolution() const { return resolution; }
+	size_t memoryUsage() const { return (fwd.capacity() + bwd.capacity()) * sizeof(uint32_t); }
+
+	double lowerBound(unsigned v, unsigned t) const;
+	void shortestPath(const T &s, const T &t);
+
+private:
+	static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+	Graph<T, Alloc> &graph;
+	unsigned n;
+	vector<uint32_t> landmarks;
+	double resolution = 1;
+	vector<uint32_t> fwd;    // fwd[v * k + i]: dist(landmark i, v)
+	vector<uint32_t> bwd;    // bwd[v * k + i]: dist(v, landmark i)
+
+	void distances(unsigned source, bool backward, vector<double> &dist, vector<uint32_t> *parent) const;
+	void selectFarthest(unsigned k, mt19937 &g);
+	void selectAvoid(unsigned k, mt19937 &g);
+	void fill(unsigned threads);
+};
+
+template <class T, class Alloc>
+void Landmarks<T, Alloc>::distances(unsigned source, bool backward, vector<double> &dist, vector<uint32_t> *parent) const {
+	distanceField(graph, source, backward, dist, parent);
+}
+
+template <class T, class Alloc>
+Landmarks<T, Alloc>::Landmarks(Graph<T, Alloc> &graph, unsigned k, Strategy strategy, unsigned threads, unsigned seed) : graph(graph) {
+	n = graph.getNumVertex();
+	if (n == 0 || k == 0)
+		return;
+	k = min(k, n);
+
+	// Resolução: nenhum caminho mais curto é maior que a soma de todas as arestas
+	double total = 0;
+	for (unsigned v = 0; v < n; v++)
+		for (auto &e : graph.getVertex(v)->getOutgoing())
+			total += e.getWeight();
+	resolution = max(total, 1.0) / (UNREACHABLE - 1);
+
+	mt19937 g(seed);
+	if (strategy == FARTHEST)
+		selectFarthest(k, g);
+	else
+		selectAvoid(k, g);
+	fill(threads);
+}
+
+/*
+ * Each new landmark is the vertex farthest from the ones already chosen
+ * (the first one, from a random vertex).
+ */
+template <class T, class Alloc>
+void Landmarks<T, Alloc>::selectFarthest(unsigned k, mt19937 &g) {
+	vector<double> closest, dist;
+	distances(uniform_int_distribution<unsigned>(0, n - 1)(g), false, closest, nullptr);
+	while (landmarks.size() < k) {
+		unsigned best = UINT32_MAX;
+		for (unsigned v = 0; v < n; v++)
+			if (closest[v] != INF && closest[v] > 0 && (best == UINT32_MAX || closest[v] > closest[best]))
+				best = v;
+		if (best == UINT32_MAX)
+			break;
+		if (landmarks.empty())
+			closest.assign(n, INF);
+		landmarks.push_back(best);
+		distances(best, false, dist, nullptr);
+		for (unsigned v = 0; v < n; v++)
+			closest[v] = min(closest[v], dist[v]);
+	}
+}
+
+/*
+ * "Avoid": grow a shortest path tree from a random root, weigh each vertex
+ * by how badly the current landmarks bound its distance from the root, and
+ * take the leaf at the end of the heaviest subtree without landmarks.
+ * Only the forward bounds are used while selecting.
+ */
+template <class T, class Alloc>
+void Landmarks<T, Alloc>::selectAvoid(unsigned k, mt19937 &g) {
+	selectFarthest(1, g);
+	vector<vector<double>> selected(landmarks.size());
+	for (unsigned i = 0; i < landmarks.size(); i++)
+		distances(landmarks[i], false, selected[i], nullptr);
+
+	uniform_int_distribution<unsigned> pick(0, n - 1);
+	vector<double> dist, size(n);
+	vector<uint32_t> parent, order(n);
+	vector<bool> hasLandmark(n), isLandmark(n, false);
+	for (auto l : landmarks)
+		isLandmark[l] = true;
+
+	for (unsigned tries = 0; landmarks.size() < k && tries < 4 * k; tries++) {
+		unsigned root = pick(g);
+		distances(root, false, dist, &parent);
+
+		// Pesos: erro do limite inferior actual (raiz -> v)
+		for (unsigned v = 0; v < n; v++) {
+			size[v] = 0;
+			hasLandmark[v] = isLandmark[v];
+			if (dist[v] == INF)
+				continue;
+			double bound = 0;
+			for (auto &d : selected)
+				if (d[root] != INF && d[v] != INF)
+					bound = max(bound, d[v] - d[root]);
+			size[v] = dist[v] - bound;
+		}
+
+		// Tamanho das sub-árvores, das folhas para a raiz
+		for (unsigned v = 0; v < n; v++)
+			order[v] = v;
+		sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return dist[a] > dist[b]; });
+		for (auto v : order) {
+			if (dist[v] == INF || parent[v] == UINT32_MAX)
+				continue;
+			if (hasLandmark[v])
+				size[v] = 0;
+			hasLandmark[parent[v]] = hasLandmark[parent[v]] || hasLandmark[v];
+			size[parent[v]] += size[v];
+		}
+
+		// Descer pela sub-árvore mais pesada até uma folha
+		vector<vector<uint32_t>> children(n);
+		for (unsigned v = 0; v < n; v++)
+			if (dist[v] != INF && parent[v] != UINT32_MAX)
+				children[parent[v]].push_back(v);
+		unsigned v = root;
+		while (true) {
+			unsigned next = UINT32_MAX;
+			for (auto c : children[v])
+				if (size[c] > 0 && (next == UINT32_MAX || size[c] > size[next]))
+					next = c;
+			if (next == UINT32_MAX)
+				break;
+			v = next;
+		}
+		if (v == root || isLandmark[v])
+			continue;
+
+		landmarks.push_back(v);
+		isLandmark[v] = true;
+		selected.emplace_back();
+		distances(v, false, selected.back(), nullptr);
+	}
+}
+
+/*
+ * Forward and backward distances of every landmark, one search per task,
+ * spread over "threads" threads (0: one per core).
+ */
+template <class T, class Alloc>
+void Landmarks<T, Alloc>::fill(unsigned threads) {
+	unsigned k = landmarks.size();
+	fwd.assign((size_t)n * k, UNREACHABLE);
+	bwd.assign((size_t)n * k, UNREACHABLE);
+	if (threads == 0)
+		threads = max(1u, thread::hardware_concurrency());
+
+	atomic<unsigned> next(0);
+	auto worker = [&]() {
+		vector<double> dist;
+		for (unsigned task; (task = next++) < 2 * k; ) {
+			unsigned i = task / 2;
+			bool backward = task % 2;
+			distances(landmarks[i], backward, dist, nullptr);
+			vector<uint32_t> &out = backward ? bwd : fwd;
+			for (unsigned v = 0; v < n; v++)
+				if (dist[v] != INF)
+					out[(size_t)v * k + i] = (uint32_t)min(dist[v] / resolution, (double)(UNREACHABLE - 1));
+		}
+	};
+	vector<thread> pool;
+	for (unsigned t = 1; t < min(threads, 2 * k); t++)
+		pool.emplace_back(worker);
+	worker();
+	for (auto &t : pool)
+		t.join();
+}
+
+/*
+ * max over the landmarks of d(L, t) - d(L, v) and d(v, L) - d(t, L).
+ */
+template <class T, class Alloc>
+double Landmarks<T, Alloc>::lowerBound(unsigned v, unsigned t) const {
+	size_t k = landmarks.size();
+	const uint32_t *fv = &fwd[v * k], *ft = &fwd[t * k];
+	const uint32_t *bv = &bwd[v * k], *bt = &bwd[t * k];
+	int64_t best = 0;
+	for (size_t i = 0; i < k; i++) {
+		if (fv[i] != UNREACHABLE && ft[i] != UNREACHABLE)
+			best = max(best, (int64_t)ft[i] - fv[i] - 1);
+		if (bv[i] != UNREACHABLE && bt[i] != UNREACHABLE)
+			best = max(best, (int64_t)bv[i] - bt[i] - 1);
+	}
+	return best * resolution;
+}
+
+/*
+ * A* from s to t guided by the landmark bounds (results in the graph's
+ * dist/path fields, as with the other searches).
+ */
+template <class T, class Alloc>
+void Landmarks<T, Alloc>::shortestPath(const T &s, const T &t) {
+	auto target = graph.findVertex(t);
+	if (target == nullptr || landmarks.empty()) {
+		graph.dijkstraShortestPath(s);
+		return;
+	}
+	unsigned ti = target->getIndex();
+	graph.aStarShortestPath(s, t, [this, ti](const Vertex<T> *v) { return lowerBound(v->getIndex(), ti); });
+}
+
+#endif /* LANDMARKS_H_ */
@@ -0,0 +1,129 @@
+/*
+ * SearchStats.h
+ * Opt-in instrumentation counters for the graph search algorithms.
+ *
+ * The counters are compiled out unless GRAPH_STATS is defined
+ * (make STATS=1), so the default build pays nothing for them.
+ */
+
+#ifndef SEARCHSTATS_H_
+#define SEARCHSTATS_H_
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+
+#ifdef GRAPH_STATS
+constexpr bool GRAPH_STATS_ENABLED = true;
+#else
+constexpr bool GRAPH_STATS_ENABLED = false;
+#endif
+
+/*
+ * Raw counters gathered by the search algorithms.
+ */
+struct SearchCounters {
+	unsigned long long searches = 0;              // number of algorithm calls
+	unsigned long long verticesSettled = 0;       // vertices taken out of the queue / scanned
+	unsigned long long edgesRelaxed = 0;          // edges examined
+	unsigned long long successfulRelaxations = 0; // edges that improved a distance
+	unsigned long long queueOps = 0;              // insert / extract / decreaseKey / push / pop
+	unsigned long long bytesTouched = 0;          // estimate of vertex and edge memory read
+
+	SearchCounters& operator+=(const SearchCounters& o) {
+		searches += o.searches;
+		verticesSettled += o.verticesSettled;
+		edgesRelaxed += o.edgesRelaxed;
+		successfulRelaxations += o.successfulRelaxations;
+		queueOps += o.queueOps;
+		bytesTouched += o.bytesTouched;
+		return *this;
+	}
+
+	SearchCounters operator-(const SearchCounters& o) const {
+		SearchCounters res;
+		res.searches = searches - o.searches;
+		res.verticesSettled = verticesSettled - o.verticesSettled;
+		res.edgesRelaxed = edgesRelaxed - o.edgesRelaxed;
+		res.successfulRelaxations = successfulRelaxations - o.successfulRelaxations;
+		res.queueOps = queueOps - o.queueOps;
+		res.bytesTouched = bytesTouched - o.bytesTouched;
+		return res;
+	}
+};
+
+/*
+ * Counter sink used by Graph. With Enabled == false every method is an
+ * empty inline function and the calls disappear from the generated code.
+ */
+template <bool Enabled>
+class SearchStats {
+	SearchCounters counters;
+public:
+	void search(size_t bytes) {
+		if (Enabled) { counters.searches++; counters.bytesTouched += bytes; }
+	}
+	void settle(size_t bytes) {
+		if (Enabled) { counters.verticesSettled++; counters.bytesTouched += bytes; }
+	}
+	void relax(bool success, size_t bytes) {
+		if (Enabled) {
+			counters.edgesRelaxed++;
+			counters.bytesTouched += bytes;
+			if (success)
+				counters.successfulRelaxations++;
+		}
+	}
+	void queueOp() {
+		if (Enabled) counters.queueOps++;
+	}
+	void touch(size_t bytes) {
+		if (Enabled) counters.bytesTouched += bytes;
+	}
+	const SearchCounters& get() const { return counters; }
+	void reset() { counters = SearchCounters(); }
+};
+
+/*
+ * Counters aggregated per top-level operation (e.g. "findSubOptimalDeliveryRoute").
+ */
+typedef std::map<std::string, SearchCounters> StatsReport;
+
+/*
+ * Adds to report[name] everything the source counters gathered while
+ * the scope was alive. Nested scopes are allowed.
+ */
+class StatsScope {
+	const SearchCounters& source;
+	SearchCounters start;
+	StatsReport& report;
+	std::string name;
+public:
+	StatsScope(const SearchCounters& source, StatsReport& report, const std::string& name)
+		: source(source), start(source), report(report), name(name) {}
+	~StatsScope() {
+		if (GRAPH_STATS_ENABLED)
+			report[name] += source - start;
+	}
+};
+
+/*
+ * Prints one line per operation, in the same "key : value" style as the benchmark output.
+ */
+inline void printStatsReport(std::ostream& os, const StatsReport& report) {
+	if (!GRAPH_STATS_ENABLED)
+		return;
+	for (auto& entry : report) {
+		const SearchCounters& c = entry.second;
+		os << "[stats] " << entry.first
+		   << " | searches: " << c.searches
+		   << " | settled: " << c.verticesSettled
+		   << " | relaxed: " << c.edgesRelaxed
+		   << " | improved: " << c.successfulRelaxations
+		   << " | queue ops: " << c.queueOps
+		   << " | bytes: " << c.bytesTouched << std::endl;
+	}
+}
+
+#endif /* SEARCHSTATS_H_ */
@@ -0,0 +1,93 @@
+#ifndef SVGRENDERER_H
+#define SVGRENDERER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Headless replacement for GraphViewer: accepts the same drawing calls
+ * (nodes, edges, colours, sizes) and writes the result to an SVG file,
+ * without the Java process or the socket round-trips.
+ *
+ * Level of detail: edges and nodes with the default style are snapped to a
+ * grid of "cell" pixels; edges inside one cell are dropped and edges joining
+ * the same pair of cells are drawn once. Styled primitives (routes,
+ * packages) are always drawn as given, on top.
+ */
+class SvgRenderer
+{
+public:
+	SvgRenderer(int width, int height);
+
+	bool addNode(int id, int x, int y);
+	bool addEdge(int id, int v1, int v2, int edgeType);
+	bool removeNode(int id);
+	bool removeEdge(int id);
+
+	bool setVertexLabel(int id, std::string label);
+	bool setVertexColor(int id, std::string color);
+	bool setVertexSize(int id, int size);
+	bool setEdgeColor(int id, std::string color);
+	bool setEdgeThickness(int id, int thickness);
+	bool setEdgeDashed(int id, bool dashed);
+
+	bool defineVertexColor(std::string color);
+	bool defineVertexSize(int size);
+	bool defineEdgeColor(std::string color);
+	bool defineEdgeDashed(bool dashed);
+	bool defineEdgeCurved(bool) { return true; }	// always straight
+
+	bool rearrange() { return true; }	// nothing to refresh
+
+	void setCellSize(double pixels);
+	bool write(const std::string &path);
+
+	// Figures of the last write()
+	size_t edgesDrawn() const { return drawnEdges; }
+	size_t edgesMerged() const { return mergedEdges; }
+	size_t nodesDrawn() const { return drawnNodes; }
+
+	static std::string svgColor(const std::string &color);
+
+private:
+	struct NodeItem
+	{
+		double x, y;
+		int16_t color = -1;	// -1: default
+		int size = -1;
+		std::string label;
+		bool removed = false;
+	};
+	struct EdgeItem
+	{
+		int v1, v2;
+		int16_t color = -1;
+		int thickness = -1;
+		int8_t dashed = -1;
+		bool removed = false;
+	};
+
+	int width, height;
+	double cell = 2;
+
+	std::vector<std::string> palette;
+	std::unordered_map<std::string, int16_t> paletteIndex;
+	int16_t nodeColor, edgeColor;
+	int nodeSize = 20;
+	bool edgeDashed = false;
+
+	std::vector<NodeItem> nodes;
+	std::vector<EdgeItem> edges;
+	std::unordered_map<int, size_t> nodeIndex, edgeIndex;
+
+	size_t drawnEdges = 0, mergedEdges = 0, drawnNodes = 0;
+
+	int16_t colorIndex(const std::string &color);
+	NodeItem *node(int id);
+	EdgeItem *edge(int id);
+};
+
+#endif
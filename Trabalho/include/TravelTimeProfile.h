@@ -0,0 +1,60 @@
+#ifndef TRAVELTIMEPROFILE_H
+#define TRAVELTIMEPROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Congestion profile for one class of road, periodic over a day.
+ * Piecewise-linear factor applied to the free-flow travel time, with
+ * quantised breakpoints (minute of the day, factor in 1/1024 steps).
+ */
+class TravelTimeProfile
+{
+public:
+	static const unsigned DAY = 24 * 60 * 60;   // period in seconds
+	static const unsigned FACTOR_SCALE = 1024;
+
+	void addBreakpoint(double secondsOfDay, double factor);
+	double factorAt(double seconds) const;
+	double minFactor() const;
+	double minSlope() const;	// most negative slope (factor per second)
+	size_t memoryUsage() const;
+
+private:
+	struct Breakpoint
+	{
+		uint16_t minute;
+		uint16_t factor;
+	};
+	std::vector<Breakpoint> points;	// sorted by minute
+};
+
+/**
+ * Time-dependent travel times for the whole graph: a few shared profiles and
+ * one byte per edge (indexed by edge ID) selecting the profile to use.
+ */
+class TravelTimes
+{
+public:
+	explicit TravelTimes(double freeFlowSpeed);
+
+	// Id of the new profile, or -1 if there are already MAX_PROFILES (edges keep one byte)
+	static const size_t MAX_PROFILES = 256;
+	int addProfile(const TravelTimeProfile &profile);
+	void setEdgeProfile(int edgeID, uint8_t profile);
+
+	double travelTime(int edgeID, double length, double departure) const;
+	double lowerBound(double length) const;
+	bool isFIFO(double maxLength) const;
+	size_t memoryUsage() const;
+
+private:
+	double speed;	// free-flow speed (length units per second)
+	double fastestFactor = 1;
+	std::vector<TravelTimeProfile> profiles;
+	std::vector<uint8_t> edgeProfile;
+};
+
+#endif
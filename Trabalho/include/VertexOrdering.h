@@ -0,0 +1,108 @@
+/*
+ * VertexOrdering.h
+ * Vertex orders with memory locality, to be applied with Graph::renumber.
+ * Each function returns "order", where order[i] is the current index of
+ * the vertex that should get index i.
+ */
+
+#ifndef VERTEXORDERING_H_
+#define VERTEXORDERING_H_
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <cstdint>
+#include "Graph.h"
+
+/*
+ * Position of (x, y) along a Hilbert curve over a 2^16 x 2^16 grid.
+ */
+inline uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+	const uint32_t n = 1u << 16;
+	uint64_t d = 0;
+	for (uint32_t s = n / 2; s > 0; s /= 2) {
+		uint32_t rx = (x & s) > 0;
+		uint32_t ry = (y & s) > 0;
+		d += (uint64_t)s * s * ((3 * rx) ^ ry);
+		// rotate the quadrant
+		if (ry == 0) {
+			if (rx == 1) {
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			swap(x, y);
+		}
+	}
+	return d;
+}
+
+/*
+ * Sorts the vertices along a Hilbert curve, so that vertices close in the
+ * plane end up close in memory. coords(info) returns a pair (x, y).
+ */
+template <class T, class Alloc, class Coords>
+vector<uint32_t> hilbertOrder(const Graph<T, Alloc> &graph, Coords coords) {
+	unsigned n = graph.getNumVertex();
+	vector<uint32_t> order(n);
+	if (n == 0)
+		return order;
+
+	double minX = INF, minY = INF, maxX = -INF, maxY = -INF;
+	for (unsigned i = 0; i < n; i++) {
+		auto c = coords(graph.getVertex(i)->getInfo());
+		minX = min(minX, c.first);
+		maxX = max(maxX, c.first);
+		minY = min(minY, c.second);
+		maxY = max(maxY, c.second);
+	}
+	double scale = 65535 / max(max(maxX - minX, maxY - minY), 1e-9);
+
+	vector<pair<uint64_t, uint32_t>> keys(n);
+	for (unsigned i = 0; i < n; i++) {
+		auto c = coords(graph.getVertex(i)->getInfo());
+		keys[i] = { hilbertIndex((uint32_t)((c.first - minX) * scale), (uint32_t)((c.second - minY) * scale)), i };
+	}
+	sort(keys.begin(), keys.end());
+	for (unsigned i = 0; i < n; i++)
+		order[i] = keys[i].second;
+	return order;
+}
+
+/*
+ * Breadth-first order, ignoring edge directions, starting at index "start".
+ * Vertices not reached are appended component by component.
+ */
+template <class T, class Alloc>
+vector<uint32_t> bfsOrder(const Graph<T, Alloc> &graph, unsigned start) {
+	unsigned n = graph.getNumVertex();
+	vector<uint32_t> order;
+	vector<bool> seen(n, false);
+	order.reserve(n);
+	queue<uint32_t> q;
+	for (unsigned k = 0; k <= n; k++) {
+		unsigned root = (k == 0) ? start : k - 1;
+		if (root >= n || seen[root])
+			continue;
+		q.push(root);
+		seen[root] = true;
+		while (!q.empty()) {
+			auto i = q.front();
+			q.pop();
+			order.push_back(i);
+			auto v = graph.getVertex(i);
+			for (auto &e : v->getOutgoing())
+				if (!seen[e.getDest()]) {
+					seen[e.getDest()] = true;
+					q.push(e.getDest());
+				}
+			for (auto &r : v->getIngoing())
+				if (!seen[r.getOrig()]) {
+					seen[r.getOrig()] = true;
+					q.push(r.getOrig());
+				}
+		}
+	}
+	return order;
+}
+
+#endif /* VERTEXORDERING_H_ */
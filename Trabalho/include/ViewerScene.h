@@ -0,0 +1,497 @@
+/*
+ * ViewerScene.h
+ * Retained scene on top of a viewer (GraphViewer, SvgRenderer, ...).
+ *
+ * The whole map is kept here; commit() only sends what the viewer is
+ * missing: primitives inside the current viewport, degree-2 chains of
+ * unstyled roads as a single edge, and attributes changed since the last
+ * frame (dirty tracking). One rearrange() per frame.
+ */
+
+#ifndef VIEWERSCENE_H_
+#define VIEWERSCENE_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include "edgetype.h"
+
+template <class Viewer>
+class ViewerScene {
+	enum Dirty { COLOR = 1, SIZE = 2, LABEL = 4, THICKNESS = 8, DASHED = 16 };
+
+	struct NodeItem {
+		int id;
+		double x, y;
+		std::string color, label;
+		int size = -1;
+		unsigned dirty = 0;
+		bool sent = false;
+		bool inChain = false;	// hidden inside a collapsed chain
+	};
+	struct EdgeItem {
+		int id;
+		unsigned v1, v2;
+		int type;
+		std::string color;
+		int thickness = -1;
+		int dashed = -1;
+		unsigned dirty = 0;
+		bool sent = false;
+		bool inChain = false;
+		bool removed = false;
+	};
+	struct Chain {
+		int id;					// edge ID used in the viewer
+		unsigned v1, v2;		// end nodes (not collapsed)
+		int type;
+		double minX, minY, maxX, maxY;
+	};
+
+	Viewer *viewer;
+	std::vector<NodeItem> nodes;
+	std::vector<EdgeItem> edges;
+	std::vector<Chain> chains;
+	std::unordered_map<int, unsigned> nodeIndex, edgeIndex;
+	std::unordered_map<int, std::pair<unsigned, unsigned>> sentChains;	// chain ID -> ends
+	std::unordered_map<uint64_t, int> chainIDs;	// (first node, first edge) -> chain ID
+	int nextChainID = std::numeric_limits<int>::max();	// counts down
+
+	double viewMinX, viewMinY, viewMaxX, viewMaxY;
+	unsigned long commands = 0;
+
+	NodeItem *node(int id);
+	EdgeItem *edge(int id);
+	bool styled(const NodeItem &n) const { return !n.color.empty() || n.size >= 0 || !n.label.empty(); }
+	bool styled(const EdgeItem &e) const { return !e.color.empty() || e.thickness >= 0 || e.dashed >= 0; }
+	// A dirty attribute went back to the viewer's default, which cannot be sent
+	bool reset(const NodeItem &n) const {
+		return ((n.dirty & COLOR) && n.color.empty()) || ((n.dirty & SIZE) && n.size < 0) || ((n.dirty & LABEL) && n.label.empty());
+	}
+	bool reset(const EdgeItem &e) const {
+		return ((e.dirty & COLOR) && e.color.empty()) || ((e.dirty & THICKNESS) && e.thickness < 0) || ((e.dirty & DASHED) && e.dashed < 0);
+	}
+	bool visible(double minX, double minY, double maxX, double maxY) const;
+	void expandChains();
+	void sendNode(NodeItem &n, unsigned attributes);
+	void sendEdge(EdgeItem &e, unsigned attributes);
+
+public:
+	ViewerScene(Viewer *viewer);
+
+	void addNode(int id, double x, double y);
+	void addEdge(int id, int v1, int v2, int edgeType);
+	void removeEdge(int id);
+
+	void setVertexColor(int id, const std::string &color);
+	void setVertexSize(int id, int size);
+	void setVertexLabel(int id, const std::string &label);
+	void setEdgeColor(int id, const std::string &color);
+	void setEdgeThickness(int id, int thickness);
+	void setEdgeDashed(int id, bool dashed);
+
+	// Global defaults go straight to the viewer
+	void defineVertexColor(const std::string &color) { viewer->defineVertexColor(color); commands++; }
+	void defineVertexSize(int size) { viewer->defineVertexSize(size); commands++; }
+	void defineEdgeColor(const std::string &color) { viewer->defineEdgeColor(color); commands++; }
+	void defineEdgeCurved(bool curved) { viewer->defineEdgeCurved(curved); commands++; }
+	void defineEdgeDashed(bool dashed) { viewer->defineEdgeDashed(dashed); commands++; }
+
+	// Same call as GraphViewer, so the drawing functions work on a scene too
+	void rearrange() { commit(); }
+
+	void setViewport(double minX, double minY, double maxX, double maxY);
+	unsigned collapseChains();
+	unsigned long commit();
+
+	unsigned long commandsSent() const { return commands; }
+};
+
+template <class Viewer>
+ViewerScene<Viewer>::ViewerScene(Viewer *viewer) : viewer(viewer) {
+	viewMinX = viewMinY = std::numeric_limits<double>::lowest();
+	viewMaxX = viewMaxY = std::numeric_limits<double>::max();
+}
+
+template <class Viewer>
+typename ViewerScene<Viewer>::NodeItem *ViewerScene<Viewer>::node(int id) {
+	auto it = nodeIndex.find(id);
+	return (it == nodeIndex.end()) ? nullptr : &nodes[it->second];
+}
+
+template <class Viewer>
+typename ViewerScene<Viewer>::EdgeItem *ViewerScene<Viewer>::edge(int id) {
+	auto it = edgeIndex.find(id);
+	return (it == edgeIndex.end()) ? nullptr : &edges[it->second];
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::addNode(int id, double x, double y) {
+	if (node(id) != nullptr)
+		return;
+	nodeIndex[id] = nodes.size();
+	NodeItem n;
+	n.id = id;
+	n.x = x;
+	n.y = y;
+	nodes.push_back(n);
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::addEdge(int id, int v1, int v2, int edgeType) {
+	EdgeItem *old = edge(id);
+	if ((old != nullptr && !old->removed) || node(v1) == nullptr || node(v2) == nullptr)
+		return;
+	EdgeItem e;
+	e.id = id;
+	e.v1 = nodeIndex[v1];
+	e.v2 = nodeIndex[v2];
+	e.type = edgeType;
+	if (old != nullptr) {
+		// Aresta removida e acrescentada de novo: se o viewer ainda mostra a
+		// antiga, apagá-la já, para ser enviada outra vez sem os atributos antigos
+		e.sent = old->sent;
+		*old = e;
+		if (e.sent) {
+			viewer->removeEdge(id);
+			old->sent = false;
+			commands++;
+		}
+		return;
+	}
+	edgeIndex[id] = edges.size();
+	edges.push_back(e);
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::removeEdge(int id) {
+	EdgeItem *e = edge(id);
+	if (e != nullptr)
+		e->removed = true;
+}
+
+/*
+ * Attribute setters only touch the scene; a change marks the attribute
+ * dirty, and styling a collapsed node/edge expands its chains at commit().
+ */
+template <class Viewer>
+void ViewerScene<Viewer>::setVertexColor(int id, const std::string &color) {
+	NodeItem *n = node(id);
+	if (n != nullptr && n->color != color) {
+		n->color = color;
+		n->dirty |= COLOR;
+	}
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::setVertexSize(int id, int size) {
+	NodeItem *n = node(id);
+	if (n != nullptr && n->size != size) {
+		n->size = size;
+		n->dirty |= SIZE;
+	}
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::setVertexLabel(int id, const std::string &label) {
+	NodeItem *n = node(id);
+	if (n != nullptr && n->label != label) {
+		n->label = label;
+		n->dirty |= LABEL;
+	}
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::setEdgeColor(int id, const std::string &color) {
+	EdgeItem *e = edge(id);
+	if (e != nullptr && e->color != color) {
+		e->color = color;
+		e->dirty |= COLOR;
+	}
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::setEdgeThickness(int id, int thickness) {
+	EdgeItem *e = edge(id);
+	if (e != nullptr && e->thickness != thickness) {
+		e->thickness = thickness;
+		e->dirty |= THICKNESS;
+	}
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::setEdgeDashed(int id, bool dashed) {
+	EdgeItem *e = edge(id);
+	if (e != nullptr && e->dashed != (int)dashed) {
+		e->dashed = dashed;
+		e->dirty |= DASHED;
+	}
+}
+
+/*
+ * Only primitives whose bounding box meets the viewport are sent.
+ */
+template <class Viewer>
+void ViewerScene<Viewer>::setViewport(double minX, double minY, double maxX, double maxY) {
+	viewMinX = minX;
+	viewMinY = minY;
+	viewMaxX = maxX;
+	viewMaxY = maxY;
+}
+
+template <class Viewer>
+bool ViewerScene<Viewer>::visible(double minX, double minY, double maxX, double maxY) const {
+	return maxX >= viewMinX && minX <= viewMaxX && maxY >= viewMinY && minY <= viewMaxY;
+}
+
+/*
+ * Replaces every maximal chain of unstyled nodes with exactly two
+ * neighbours by one edge between its ends (directed if all of its edges
+ * go the same way). Returns the number of chains.
+ */
+template <class Viewer>
+unsigned ViewerScene<Viewer>::collapseChains() {
+	expandChains();
+
+	// Vizinhos distintos de cada nó, e arestas incidentes
+	std::vector<std::vector<unsigned>> incident(nodes.size());
+	for (unsigned i = 0; i < edges.size(); i++)
+		if (!edges[i].removed) {
+			incident[edges[i].v1].push_back(i);
+			incident[edges[i].v2].push_back(i);
+		}
+	auto other = [&](unsigned e, unsigned v) { return edges[e].v1 == v ? edges[e].v2 : edges[e].v1; };
+	std::vector<bool> interior(nodes.size(), false);
+	for (unsigned v = 0; v < nodes.size(); v++) {
+		if (styled(nodes[v]))
+			continue;
+		std::vector<unsigned> neighbours;
+		bool plain = true;
+		for (unsigned e : incident[v]) {
+			plain = plain && !styled(edges[e]);
+			unsigned w = other(e, v);
+			if (std::find(neighbours.begin(), neighbours.end(), w) == neighbours.end())
+				neighbours.push_back(w);
+		}
+		interior[v] = plain && neighbours.size() == 2 && std::find(neighbours.begin(), neighbours.end(), v) == neighbours.end();
+	}
+
+	// IDs das cadeias: a descer a partir de INT_MAX (longe dos IDs das
+	// arestas e das encomendas), estáveis entre chamadas
+
+	std::vector<bool> walked(edges.size(), false);
+	for (unsigned start = 0; start < nodes.size(); start++) {
+		if (interior[start])
+			continue;
+		for (unsigned first : incident[start]) {
+			unsigned next = other(first, start);
+			if (walked[first] || !interior[next])
+				continue;
+
+			// Percorrer a cadeia até um nó que não seja interior
+			std::vector<unsigned> chainEdges, chainNodes;
+			unsigned prev = start, cur = next;
+			bool forward = true, backward = true;
+			while (true) {
+				for (unsigned e : incident[prev])
+					if (other(e, prev) == cur && !walked[e]) {
+						walked[e] = true;
+						chainEdges.push_back(e);
+						bool fwd = (edges[e].v1 == prev);
+						forward = forward && (fwd && edges[e].type == EdgeType::DIRECTED);
+						backward = backward && (!fwd && edges[e].type == EdgeType::DIRECTED);
+					}
+				if (!interior[cur])
+					break;
+				chainNodes.push_back(cur);
+				unsigned step = cur;
+				for (unsigned e : incident[cur])
+					if (other(e, cur) != prev) {
+						cur = other(e, cur);
+						break;
+					}
+				prev = step;
+			}
+			if (cur == start)
+				continue;	// ciclo: manter as arestas originais
+
+			Chain c;
+			auto key = chainIDs.find((uint64_t)start << 32 | first);
+			c.id = (key != chainIDs.end()) ? key->second : (chainIDs[(uint64_t)start << 32 | first] = nextChainID--);
+			c.v1 = backward ? cur : start;
+			c.v2 = backward ? start : cur;
+			c.type = (forward || backward) ? EdgeType::DIRECTED : EdgeType::UNDIRECTED;
+			c.minX = std::min(nodes[start].x, nodes[cur].x);
+			c.maxX = std::max(nodes[start].x, nodes[cur].x);
+			c.minY = std::min(nodes[start].y, nodes[cur].y);
+			c.maxY = std::max(nodes[start].y, nodes[cur].y);
+			for (unsigned v : chainNodes) {
+				nodes[v].inChain = true;
+				c.minX = std::min(c.minX, nodes[v].x);
+				c.maxX = std::max(c.maxX, nodes[v].x);
+				c.minY = std::min(c.minY, nodes[v].y);
+				c.maxY = std::max(c.maxY, nodes[v].y);
+			}
+			for (unsigned e : chainEdges)
+				edges[e].inChain = true;
+			chains.push_back(c);
+		}
+	}
+	return chains.size();
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::expandChains() {
+	chains.clear();
+	for (auto &n : nodes)
+		n.inChain = false;
+	for (auto &e : edges)
+		e.inChain = false;
+}
+
+/*
+ * Unset attributes are not sent: the element was just added with the
+ * defaults, or commit() removed it and added it again to reset them.
+ */
+template <class Viewer>
+void ViewerScene<Viewer>::sendNode(NodeItem &n, unsigned attributes) {
+	if ((attributes & COLOR) && !n.color.empty()) {
+		viewer->setVertexColor(n.id, n.color);
+		commands++;
+	}
+	if ((attributes & SIZE) && n.size >= 0) {
+		viewer->setVertexSize(n.id, n.size);
+		commands++;
+	}
+	if ((attributes & LABEL) && !n.label.empty()) {
+		viewer->setVertexLabel(n.id, n.label);
+		commands++;
+	}
+	n.dirty = 0;
+}
+
+template <class Viewer>
+void ViewerScene<Viewer>::sendEdge(EdgeItem &e, unsigned attributes) {
+	if ((attributes & COLOR) && !e.color.empty()) {
+		viewer->setEdgeColor(e.id, e.color);
+		commands++;
+	}
+	if ((attributes & THICKNESS) && e.thickness >= 0) {
+		viewer->setEdgeThickness(e.id, e.thickness);
+		commands++;
+	}
+	if ((attributes & DASHED) && e.dashed >= 0) {
+		viewer->setEdgeDashed(e.id, e.dashed);
+		commands++;
+	}
+	e.dirty = 0;
+}
+
+/*
+ * Sends the difference between the scene and what the viewer shows.
+ * Returns the number of commands sent in this frame.
+ */
+template <class Viewer>
+unsigned long ViewerScene<Viewer>::commit() {
+	unsigned long before = commands;
+	const unsigned ALL = COLOR | SIZE | LABEL | THICKNESS | DASHED;
+
+	// Cadeias que deixam de ser válidas (um elemento passou a ter estilo ou foi removido)
+	bool broken = false;
+	for (auto &n : nodes)
+		broken = broken || (n.inChain && styled(n));
+	for (auto &e : edges)
+		broken = broken || (e.inChain && (styled(e) || e.removed));
+	if (broken)
+		collapseChains();
+
+	// O que deve estar visível neste frame
+	std::vector<bool> wantNode(nodes.size(), false), wantEdge(edges.size(), false);
+	std::unordered_map<int, std::pair<unsigned, unsigned>> wantChains;
+	for (unsigned i = 0; i < nodes.size(); i++) {
+		auto &n = nodes[i];
+		wantNode[i] = !n.inChain && visible(n.x, n.y, n.x, n.y);
+	}
+	for (unsigned i = 0; i < edges.size(); i++) {
+		auto &e = edges[i];
+		if (e.inChain || e.removed)
+			continue;
+		auto &a = nodes[e.v1];
+		auto &b = nodes[e.v2];
+		if (visible(std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y)))
+			wantEdge[i] = wantNode[e.v1] = wantNode[e.v2] = true;
+	}
+	for (auto &c : chains)
+		if (visible(c.minX, c.minY, c.maxX, c.maxY)) {
+			wantChains[c.id] = { c.v1, c.v2 };
+			wantNode[c.v1] = wantNode[c.v2] = true;
+		}
+
+	// Um atributo que volta ao valor por defeito não tem comando: o elemento é
+	// removido e acrescentado de novo, e com o nó também as arestas que lhe tocam
+	std::vector<bool> resendNode(nodes.size(), false);
+	for (unsigned i = 0; i < nodes.size(); i++)
+		resendNode[i] = nodes[i].sent && reset(nodes[i]);
+
+	// Remover primeiro as arestas, depois os nós
+	for (auto it = sentChains.begin(); it != sentChains.end(); )
+		if (!wantChains.count(it->first) || wantChains[it->first] != it->second
+				|| resendNode[it->second.first] || resendNode[it->second.second]) {
+			viewer->removeEdge(it->first);
+			commands++;
+			it = sentChains.erase(it);
+		}
+		else
+			++it;
+	for (unsigned i = 0; i < edges.size(); i++)
+		if (edges[i].sent && (!wantEdge[i] || reset(edges[i]) || resendNode[edges[i].v1] || resendNode[edges[i].v2])) {
+			viewer->removeEdge(edges[i].id);
+			edges[i].sent = false;
+			commands++;
+		}
+	for (unsigned i = 0; i < nodes.size(); i++)
+		if (nodes[i].sent && (!wantNode[i] || resendNode[i])) {
+			viewer->removeNode(nodes[i].id);
+			nodes[i].sent = false;
+			commands++;
+		}
+
+	// Acrescentar o que falta (com todos os atributos) e actualizar o resto
+	for (unsigned i = 0; i < nodes.size(); i++) {
+		auto &n = nodes[i];
+		if (wantNode[i] && !n.sent) {
+			viewer->addNode(n.id, (int)n.x, (int)n.y);
+			n.sent = true;
+			commands++;
+			sendNode(n, ALL);
+		}
+		else if (n.sent && n.dirty)
+			sendNode(n, n.dirty);
+	}
+	for (unsigned i = 0; i < edges.size(); i++) {
+		auto &e = edges[i];
+		if (wantEdge[i] && !e.sent) {
+			viewer->addEdge(e.id, nodes[e.v1].id, nodes[e.v2].id, e.type);
+			e.sent = true;
+			commands++;
+			sendEdge(e, ALL);
+		}
+		else if (e.sent && e.dirty)
+			sendEdge(e, e.dirty);
+	}
+	for (auto &c : chains)
+		if (wantChains.count(c.id) && !sentChains.count(c.id)) {
+			viewer->addEdge(c.id, nodes[c.v1].id, nodes[c.v2].id, c.type);
+			sentChains[c.id] = { c.v1, c.v2 };
+			commands++;
+		}
+
+	viewer->rearrange();
+	commands++;
+	return commands - before;
+}
+
+#endif /* VIEWERSCENE_H_ */
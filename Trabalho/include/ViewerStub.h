@@ -0,0 +1,36 @@
+#ifndef _VIEWER_STUB_
+#define _VIEWER_STUB_
+
+#include <atomic>
+#include <thread>
+
+/**
+ * Servidor local que imita o GraphViewerController: aceita ligações na porta
+ * indicada e responde "ok" a cada linha recebida. Permite testar e medir
+ * Connection/GraphViewer sem o processo Java.
+ *
+ * Com burst > 0, em vez de responder envia logo "burst" linhas "ok" a cada
+ * cliente e fecha a ligação (para medir a leitura de respostas).
+ */
+class ViewerStub {
+ public:
+  ViewerStub(short port, unsigned long burst = 0);
+  ~ViewerStub();
+
+  bool start();
+  void stop();
+  unsigned long linesReceived() const;
+
+ private:
+  short port;
+  unsigned long burst;
+  int listenSock = -1;
+  std::thread server;
+  std::atomic<unsigned long> lines;
+
+  void serve();
+  void serveClient(int client);
+  void sendBurst(int client);
+};
+
+#endif
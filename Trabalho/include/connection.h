@@ -10,27 +10,79 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <netdb.h>
+#include <unistd.h>
 #else
 #include <winsock2.h>
 #endif
 
 #include <string>
 #include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 using namespace std;
 
 class Connection {
  public:
   Connection(short port);
+  ~Connection();
 
   bool sendMsg(string msg);
+
+  // Reads one line (without the '\n') from an internal receive buffer.
+  // On EOF, error or timeout returns "" and readStatus() says why; a
+  // partial line is kept and completed by the next successful call.
   string readLine();
+
+  enum ReadStatus { READ_OK, READ_EOF, READ_ERROR, READ_TIMEOUT };
+  ReadStatus readStatus() const;
+
+  // Maximum time readLine waits for data, in milliseconds (0 = no limit).
+  void setTimeout(int ms);
+
+  unsigned long recvCalls() const;
+
+  static const size_t RECV_SIZE = 16 * 1024;
+
+  // Pipelined mode: messages are buffered and written in batches, and the
+  // "ok" replies are consumed by a background thread. sendMsg returns true
+  // right away; flush() writes what is left and waits for every reply.
+  void setPipelined(bool on);
+  bool isPipelined() const;
+  bool flush();
+
+  static const size_t BATCH_SIZE = 64 * 1024;
+
  private: 
 #ifdef linux
   int sock;
 #else
   SOCKET sock;
 #endif
+
+  string inBuffer;                  // received data not yet returned
+  size_t inStart = 0;               // first unread byte in inBuffer
+  size_t scanned = 0;               // bytes after inStart known to have no '\n'
+  ReadStatus status = READ_OK;
+  unsigned long recvs = 0;
+
+  bool fill();
+
+  bool pipelined = false;
+  string outBuffer;                 // messages not yet written
+  unsigned long buffered = 0;       // number of messages in outBuffer
+  unsigned long written = 0;        // messages written, waiting for a reply
+  unsigned long replied = 0;
+  unsigned long failed = 0;         // replies other than "ok"
+  bool stopReader = false;
+  bool broken = false;              // reader stopped on EOF/error
+  thread reader;
+  mutex mtx;
+  condition_variable cv;
+
+  void writeBatch();
+  void readReplies();
 };
 
 #endif
@@ -365,9 +365,26 @@ public:
 
 	/**
 	 * Função que actualiza a visualização do grafo.
+	 * Em modo pipelined, envia primeiro todos os comandos pendentes.
 	 */
 	bool rearrange();
 
+	/**
+	 * Activa ou desactiva o modo pipelined: os comandos passam a ser
+	 * acumulados e enviados em lotes, sem esperar pela resposta de cada um,
+	 * e as funções acima devolvem true de imediato.
+	 * Os erros são reportados por flush() (ou rearrange()).
+	 *
+	 * @param on true para activar, false para voltar ao modo síncrono.
+	 */
+	void setPipelined(bool on);
+
+	/**
+	 * Envia os comandos pendentes e espera pelas respectivas respostas.
+	 * Devolve false se algum comando enviado desde o último flush falhou.
+	 */
+	bool flush();
+
 #ifdef linux
 	static pid_t procId;
 #endif
@@ -0,0 +1,232 @@
+#include <cmath>
+#include <limits>
+#include "CoordinateStore.h"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+size_t CoordinateStore::add(double x, double y)
+{
+	xs.push_back(x);
+	ys.push_back(y);
+	return xs.size() - 1;
+}
+
+void CoordinateStore::set(size_t i, double x, double y)
+{
+	xs[i] = x;
+	ys[i] = y;
+}
+
+/**
+ * Moves the point to infinity: its distance to anything becomes infinite.
+ */
+void CoordinateStore::disable(size_t i)
+{
+	xs[i] = ys[i] = numeric_limits<double>::infinity();
+}
+
+void CoordinateStore::reserve(size_t n)
+{
+	xs.reserve(n);
+	ys.reserve(n);
+}
+
+void CoordinateStore::clear()
+{
+	xs.clear();
+	ys.clear();
+}
+
+double CoordinateStore::distance(size_t i, double px, double py) const
+{
+	double dx = xs[i] - px;
+	double dy = ys[i] - py;
+	return sqrt(dx * dx + dy * dy);
+}
+
+const char *CoordinateStore::kernelName()
+{
+#if defined(__AVX__)
+	return "AVX";
+#elif defined(__SSE2__)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+void CoordinateStore::squaredDistances(double px, double py, size_t first, size_t count, double *out) const
+{
+	const double *x = xs.data() + first;
+	const double *y = ys.data() + first;
+	size_t i = 0;
+#if defined(__AVX__)
+	__m256d vx = _mm256_set1_pd(px), vy = _mm256_set1_pd(py);
+	for ( ; i + 4 <= count; i += 4)
+	{
+		__m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), vx);
+		__m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), vy);
+		_mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+	}
+#elif defined(__SSE2__)
+	__m128d vx = _mm_set1_pd(px), vy = _mm_set1_pd(py);
+	for ( ; i + 2 <= count; i += 2)
+	{
+		__m128d dx = _mm_sub_pd(_mm_loadu_pd(x + i), vx);
+		__m128d dy = _mm_sub_pd(_mm_loadu_pd(y + i), vy);
+		_mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+	}
+#endif
+	for ( ; i < count; i++)
+	{
+		double dx = x[i] - px;
+		double dy = y[i] - py;
+		out[i] = dx * dx + dy * dy;
+	}
+}
+
+void CoordinateStore::distances(double px, double py, double *out) const
+{
+	size_t n = size();
+	squaredDistances(px, py, 0, n, out);
+	size_t i = 0;
+#if defined(__AVX__)
+	for ( ; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(out + i)));
+#elif defined(__SSE2__)
+	for ( ; i + 2 <= n; i += 2)
+		_mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_loadu_pd(out + i)));
+#endif
+	for ( ; i < n; i++)
+		out[i] = sqrt(out[i]);
+}
+
+/**
+ * The coordinates are gathered lane by lane; the arithmetic and the square
+ * root run on whole vectors.
+ */
+void CoordinateStore::pairDistances(const uint32_t *a, const uint32_t *b, size_t count, double *out) const
+{
+	const double *x = xs.data();
+	const double *y = ys.data();
+	size_t k = 0;
+#if defined(__AVX__)
+	for ( ; k + 4 <= count; k += 4)
+	{
+		__m256d dx = _mm256_sub_pd(_mm256_set_pd(x[b[k + 3]], x[b[k + 2]], x[b[k + 1]], x[b[k]]),
+			_mm256_set_pd(x[a[k + 3]], x[a[k + 2]], x[a[k + 1]], x[a[k]]));
+		__m256d dy = _mm256_sub_pd(_mm256_set_pd(y[b[k + 3]], y[b[k + 2]], y[b[k + 1]], y[b[k]]),
+			_mm256_set_pd(y[a[k + 3]], y[a[k + 2]], y[a[k + 1]], y[a[k]]));
+		_mm256_storeu_pd(out + k, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+	}
+#elif defined(__SSE2__)
+	for ( ; k + 2 <= count; k += 2)
+	{
+		__m128d dx = _mm_sub_pd(_mm_set_pd(x[b[k + 1]], x[b[k]]), _mm_set_pd(x[a[k + 1]], x[a[k]]));
+		__m128d dy = _mm_sub_pd(_mm_set_pd(y[b[k + 1]], y[b[k]]), _mm_set_pd(y[a[k + 1]], y[a[k]]));
+		_mm_storeu_pd(out + k, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+	}
+#endif
+	for ( ; k < count; k++)
+	{
+		double dx = x[b[k]] - x[a[k]];
+		double dy = y[b[k]] - y[a[k]];
+		out[k] = sqrt(dx * dx + dy * dy);
+	}
+}
+
+/**
+ * Keeps the running minimum per lane and reduces the lanes at the end;
+ * ties go to the lowest index, as in a plain loop.
+ */
+size_t CoordinateStore::argmin(double px, double py, size_t exclude, double &squaredDistance) const
+{
+	const double inf = numeric_limits<double>::infinity();
+	const size_t n = size();
+	const double *x = xs.data();
+	const double *y = ys.data();
+	double best = inf;
+	size_t bestIdx = n;
+	size_t i = 0;
+
+#if defined(__AVX__) || defined(__SSE2__)
+#if defined(__AVX__)
+	const size_t W = 4;
+	__m256d vx = _mm256_set1_pd(px), vy = _mm256_set1_pd(py);
+	__m256d minD = _mm256_set1_pd(inf), minI = _mm256_set1_pd(-1);
+	__m256d idx = _mm256_set_pd(3, 2, 1, 0), step = _mm256_set1_pd(W);
+	for ( ; i + W <= n; i += W)
+	{
+		__m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), vx);
+		__m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), vy);
+		__m256d d = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+		__m256d less = _mm256_cmp_pd(d, minD, _CMP_LT_OQ);
+		minD = _mm256_blendv_pd(minD, d, less);
+		minI = _mm256_blendv_pd(minI, idx, less);
+		idx = _mm256_add_pd(idx, step);
+	}
+	double laneD[W], laneI[W];
+	_mm256_storeu_pd(laneD, minD);
+	_mm256_storeu_pd(laneI, minI);
+#else
+	const size_t W = 2;
+	__m128d vx = _mm_set1_pd(px), vy = _mm_set1_pd(py);
+	__m128d minD = _mm_set1_pd(inf), minI = _mm_set1_pd(-1);
+	__m128d idx = _mm_set_pd(1, 0), step = _mm_set1_pd(W);
+	for ( ; i + W <= n; i += W)
+	{
+		__m128d dx = _mm_sub_pd(_mm_loadu_pd(x + i), vx);
+		__m128d dy = _mm_sub_pd(_mm_loadu_pd(y + i), vy);
+		__m128d d = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+		__m128d less = _mm_cmplt_pd(d, minD);
+		minD = _mm_or_pd(_mm_and_pd(less, d), _mm_andnot_pd(less, minD));
+		minI = _mm_or_pd(_mm_and_pd(less, idx), _mm_andnot_pd(less, minI));
+		idx = _mm_add_pd(idx, step);
+	}
+	double laneD[W], laneI[W];
+	_mm_storeu_pd(laneD, minD);
+	_mm_storeu_pd(laneI, minI);
+#endif
+	for (size_t l = 0; l < W; l++)
+		if (laneI[l] >= 0 && (laneD[l] < best || (laneD[l] == best && (size_t)laneI[l] < bestIdx)))
+		{
+			best = laneD[l];
+			bestIdx = (size_t)laneI[l];
+		}
+
+	// O vértice excluído pode ter ganho numa das pistas: refazer sem ele
+	if (bestIdx == exclude)
+	{
+		best = inf;
+		bestIdx = n;
+		for (size_t j = 0; j < i; j++)
+		{
+			double dx = x[j] - px;
+			double dy = y[j] - py;
+			double d = dx * dx + dy * dy;
+			if (j != exclude && d < best)
+			{
+				best = d;
+				bestIdx = j;
+			}
+		}
+	}
+#endif
+	for ( ; i < n; i++)
+	{
+		double dx = x[i] - px;
+		double dy = y[i] - py;
+		double d = dx * dx + dy * dy;
+		if (i != exclude && d < best)
+		{
+			best = d;
+			bestIdx = i;
+		}
+	}
+	squaredDistance = best;
+	return bestIdx;
+}
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "DistanceMatrix.h"
+
+#ifdef linux
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+DistanceMatrix::DistanceMatrix(unsigned hubs, unsigned vertices, uint64_t fingerprint)
+	: hubs(hubs), vertices(vertices), fingerprint(fingerprint), hubIDs(hubs, -1), owned((size_t)hubs * vertices)
+{
+	data = owned.data();
+}
+
+DistanceMatrix::DistanceMatrix(DistanceMatrix &&other)
+{
+	*this = std::move(other);
+}
+
+DistanceMatrix &DistanceMatrix::operator=(DistanceMatrix &&other)
+{
+	if (this == &other)
+		return *this;
+	release();
+	hubs = other.hubs;
+	vertices = other.vertices;
+	fingerprint = other.fingerprint;
+	hubIDs = std::move(other.hubIDs);
+	owned = std::move(other.owned);
+	mapped = other.mapped;
+	mappedSize = other.mappedSize;
+	data = other.data;
+	other.mapped = nullptr;
+	other.data = nullptr;
+	other.hubs = other.vertices = 0;
+	return *this;
+}
+
+DistanceMatrix::~DistanceMatrix()
+{
+	release();
+}
+
+void DistanceMatrix::release()
+{
+#ifdef linux
+	if (mapped != nullptr)
+		munmap(mapped, mappedSize);
+#endif
+	mapped = nullptr;
+	mappedSize = 0;
+	owned.clear();
+	data = nullptr;
+}
+
+/**
+ * Row to fill in. A mapped matrix is read-only, so it is first copied into
+ * memory (not while other threads use the matrix).
+ */
+float *DistanceMatrix::writableRow(unsigned hub)
+{
+	if (mapped != nullptr)
+		unmap();
+	return data + (size_t)hub * vertices;
+}
+
+/**
+ * Copies the rows of the mapping into "owned" and unmaps the file.
+ */
+void DistanceMatrix::unmap()
+{
+	vector<float> rows(data, data + (size_t)hubs * vertices);
+	vector<int> ids = std::move(hubIDs);
+	release();
+	hubIDs = std::move(ids);
+	owned = std::move(rows);
+	data = owned.data();
+}
+
+/**
+ * Row of the hub with the given vertex id, -1 if it is not a hub.
+ */
+int DistanceMatrix::findHub(int id) const
+{
+	auto it = find(hubIDs.begin(), hubIDs.end(), id);
+	return (it == hubIDs.end()) ? -1 : (int)(it - hubIDs.begin());
+}
+
+bool DistanceMatrix::save(const string &path) const
+{
+	ofstream file(path, ios::binary);
+	if (!file.is_open())
+		return false;
+
+	FileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "HUBD", 4);
+	header.version = 1;
+	header.hubs = hubs;
+	header.vertices = vertices;
+	header.fingerprint = fingerprint;
+
+	file.write((const char *)&header, sizeof(header));
+	file.write((const char *)hubIDs.data(), hubIDs.size() * sizeof(int));
+	file.write((const char *)data, (size_t)hubs * vertices * sizeof(float));
+	return file.good();
+}
+
+/**
+ * Replaces the contents with the matrix in "path". Fails (keeping the
+ * current contents) if the file is missing, truncated or was built for
+ * another graph.
+ */
+bool DistanceMatrix::load(const string &path, uint64_t expectedFingerprint)
+{
+	FileHeader header;
+	{
+		ifstream file(path, ios::binary);
+		if (!file.read((char *)&header, sizeof(header)))
+			return false;
+	}
+	if (memcmp(header.magic, "HUBD", 4) != 0 || header.version != 1 || header.fingerprint != expectedFingerprint)
+		return false;
+
+	size_t idsOffset = sizeof(FileHeader);
+	size_t dataOffset = idsOffset + header.hubs * sizeof(int);
+	size_t size = dataOffset + (size_t)header.hubs * header.vertices * sizeof(float);
+
+#ifdef linux
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < size)
+	{
+		close(fd);
+		return false;
+	}
+	void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return false;
+
+	release();
+	mapped = map;
+	mappedSize = size;
+	const char *base = (const char *)map;
+	hubIDs.assign((const int *)(base + idsOffset), (const int *)(base + dataOffset));
+	data = (float *)(base + dataOffset);	// read-only mapping
+#else
+	ifstream file(path, ios::binary);
+	vector<int> ids(header.hubs);
+	vector<float> rows((size_t)header.hubs * header.vertices);
+	file.seekg(idsOffset);
+	file.read((char *)ids.data(), ids.size() * sizeof(int));
+	file.read((char *)rows.data(), rows.size() * sizeof(float));
+	if (!file)
+		return false;
+
+	release();
+	hubIDs = std::move(ids);
+	owned = std::move(rows);
+	data = owned.data();
+#endif
+	hubs = header.hubs;
+	vertices = header.vertices;
+	fingerprint = header.fingerprint;
+	return true;
+}
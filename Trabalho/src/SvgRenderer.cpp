@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <unordered_set>
+#include "SvgRenderer.h"
+
+using namespace std;
+
+SvgRenderer::SvgRenderer(int width, int height) : width(width), height(height)
+{
+	nodeColor = colorIndex("LIGHT_GRAY");
+	edgeColor = colorIndex("BLACK");
+}
+
+/**
+ * Colour names used by GraphViewer (java.awt.Color constants) as SVG colours.
+ * Anything else is passed through in lower case.
+ */
+string SvgRenderer::svgColor(const string &color)
+{
+	static const unordered_map<string, string> awt = {
+		{ "BLUE", "#0000ff" }, { "RED", "#ff0000" }, { "PINK", "#ffafaf" },
+		{ "BLACK", "#000000" }, { "WHITE", "#ffffff" }, { "ORANGE", "#ffc800" },
+		{ "YELLOW", "#ffff00" }, { "GREEN", "#00ff00" }, { "CYAN", "#00ffff" },
+		{ "GRAY", "#808080" }, { "DARK_GRAY", "#404040" }, { "LIGHT_GRAY", "#c0c0c0" },
+		{ "MAGENTA", "#ff00ff" }
+	};
+	auto it = awt.find(color);
+	if (it != awt.end())
+		return it->second;
+	string res = color;
+	transform(res.begin(), res.end(), res.begin(), [](unsigned char c) { return tolower(c); });
+	return res;
+}
+
+int16_t SvgRenderer::colorIndex(const string &color)
+{
+	auto it = paletteIndex.find(color);
+	if (it != paletteIndex.end())
+		return it->second;
+	palette.push_back(svgColor(color));
+	return paletteIndex[color] = (int16_t)(palette.size() - 1);
+}
+
+SvgRenderer::NodeItem *SvgRenderer::node(int id)
+{
+	auto it = nodeIndex.find(id);
+	return (it == nodeIndex.end() || nodes[it->second].removed) ? nullptr : &nodes[it->second];
+}
+
+SvgRenderer::EdgeItem *SvgRenderer::edge(int id)
+{
+	auto it = edgeIndex.find(id);
+	return (it == edgeIndex.end() || edges[it->second].removed) ? nullptr : &edges[it->second];
+}
+
+bool SvgRenderer::addNode(int id, int x, int y)
+{
+	if (node(id) != nullptr)
+		return false;
+	NodeItem n;
+	n.x = x;
+	n.y = y;
+	nodeIndex[id] = nodes.size();
+	nodes.push_back(n);
+	return true;
+}
+
+bool SvgRenderer::addEdge(int id, int v1, int v2, int)
+{
+	if (edge(id) != nullptr || node(v1) == nullptr || node(v2) == nullptr)
+		return false;
+	EdgeItem e;
+	e.v1 = (int)nodeIndex[v1];
+	e.v2 = (int)nodeIndex[v2];
+	edgeIndex[id] = edges.size();
+	edges.push_back(e);
+	return true;
+}
+
+bool SvgRenderer::removeNode(int id)
+{
+	NodeItem *n = node(id);
+	if (n == nullptr)
+		return false;
+	n->removed = true;
+	return true;
+}
+
+bool SvgRenderer::removeEdge(int id)
+{
+	EdgeItem *e = edge(id);
+	if (e == nullptr)
+		return false;
+	e->removed = true;
+	return true;
+}
+
+bool SvgRenderer::setVertexLabel(int id, string label)
+{
+	NodeItem *n = node(id);
+	if (n == nullptr)
+		return false;
+	n->label = label;
+	return true;
+}
+
+bool SvgRenderer::setVertexColor(int id, string color)
+{
+	NodeItem *n = node(id);
+	if (n == nullptr)
+		return false;
+	n->color = colorIndex(color);
+	return true;
+}
+
+bool SvgRenderer::setVertexSize(int id, int size)
+{
+	NodeItem *n = node(id);
+	if (n == nullptr)
+		return false;
+	n->size = size;
+	return true;
+}
+
+bool SvgRenderer::setEdgeColor(int id, string color)
+{
+	EdgeItem *e = edge(id);
+	if (e == nullptr)
+		return false;
+	e->color = colorIndex(color);
+	return true;
+}
+
+bool SvgRenderer::setEdgeThickness(int id, int thickness)
+{
+	EdgeItem *e = edge(id);
+	if (e == nullptr)
+		return false;
+	e->thickness = thickness;
+	return true;
+}
+
+bool SvgRenderer::setEdgeDashed(int id, bool dashed)
+{
+	EdgeItem *e = edge(id);
+	if (e == nullptr)
+		return false;
+	e->dashed = dashed;
+	return true;
+}
+
+bool SvgRenderer::defineVertexColor(string color)
+{
+	nodeColor = colorIndex(color);
+	return true;
+}
+
+bool SvgRenderer::defineVertexSize(int size)
+{
+	nodeSize = size;
+	return true;
+}
+
+bool SvgRenderer::defineEdgeColor(string color)
+{
+	edgeColor = colorIndex(color);
+	return true;
+}
+
+bool SvgRenderer::defineEdgeDashed(bool dashed)
+{
+	edgeDashed = dashed;
+	return true;
+}
+
+/**
+ * Size of the level-of-detail grid, in pixels (0 disables merging).
+ */
+void SvgRenderer::setCellSize(double pixels)
+{
+	cell = pixels;
+}
+
+/**
+ * Writes the picture, fitted to width x height. Node sizes are in
+ * GraphViewer units: the radius in pixels is size / 10.
+ */
+bool SvgRenderer::write(const string &path)
+{
+	drawnEdges = mergedEdges = drawnNodes = 0;
+
+	double minX = numeric_limits<double>::max(), minY = minX;
+	double maxX = numeric_limits<double>::lowest(), maxY = maxX;
+	for (auto &n : nodes)
+		if (!n.removed)
+		{
+			minX = min(minX, n.x);
+			maxX = max(maxX, n.x);
+			minY = min(minY, n.y);
+			maxY = max(maxY, n.y);
+		}
+	if (minX > maxX)
+		minX = maxX = minY = maxY = 0;
+
+	const double margin = 10;
+	double scale = min((width - 2 * margin) / max(maxX - minX, 1e-9), (height - 2 * margin) / max(maxY - minY, 1e-9));
+	auto px = [&](const NodeItem &n) { return margin + (n.x - minX) * scale; };
+	auto py = [&](const NodeItem &n) { return margin + (n.y - minY) * scale; };
+
+	// Grid cell of a point, for the level-of-detail pass
+	uint64_t cols = (cell > 0) ? (uint64_t)(width / cell) + 1 : 0;
+	auto cellOf = [&](const NodeItem &n) { return (uint64_t)(py(n) / cell) * cols + (uint64_t)(px(n) / cell); };
+
+	string out;
+	char buf[256];
+	snprintf(buf, sizeof(buf), "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\">\n"
+		"<rect width=\"100%%\" height=\"100%%\" fill=\"white\"/>\n", width, height);
+	out += buf;
+
+	// Unstyled edges: one path, merged by pair of cells
+	unordered_set<uint64_t> seen;
+	if (cell > 0)
+		seen.reserve(edges.size());
+	snprintf(buf, sizeof(buf), "<path fill=\"none\" stroke=\"%s\" stroke-width=\"1\"%s d=\"",
+		palette[edgeColor].c_str(), edgeDashed ? " stroke-dasharray=\"4 3\"" : "");
+	out += buf;
+	for (auto &e : edges)
+	{
+		if (e.removed || e.color >= 0 || e.thickness >= 0 || e.dashed >= 0)
+			continue;
+		const NodeItem &a = nodes[e.v1], &b = nodes[e.v2];
+		if (a.removed || b.removed)
+			continue;
+		if (cell > 0)
+		{
+			uint64_t ca = cellOf(a), cb = cellOf(b);
+			if (ca == cb || !seen.insert(min(ca, cb) << 32 | max(ca, cb)).second)
+			{
+				mergedEdges++;
+				continue;
+			}
+		}
+		snprintf(buf, sizeof(buf), "M%.1f %.1fL%.1f %.1f", px(a), py(a), px(b), py(b));
+		out += buf;
+		drawnEdges++;
+	}
+	out += "\"/>\n";
+
+	// Unstyled nodes: one path of round dots, one per cell
+	seen.clear();
+	snprintf(buf, sizeof(buf), "<path fill=\"none\" stroke=\"%s\" stroke-width=\"%.1f\" stroke-linecap=\"round\" d=\"",
+		palette[nodeColor].c_str(), nodeSize / 5.0);
+	out += buf;
+	for (auto &n : nodes)
+	{
+		if (n.removed || n.color >= 0 || n.size >= 0 || !n.label.empty())
+			continue;
+		if (cell > 0 && !seen.insert(cellOf(n)).second)
+			continue;
+		snprintf(buf, sizeof(buf), "M%.1f %.1fh0", px(n), py(n));
+		out += buf;
+		drawnNodes++;
+	}
+	out += "\"/>\n";
+
+	// Styled edges and nodes, as given
+	for (auto &e : edges)
+	{
+		if (e.removed || (e.color < 0 && e.thickness < 0 && e.dashed < 0))
+			continue;
+		const NodeItem &a = nodes[e.v1], &b = nodes[e.v2];
+		if (a.removed || b.removed)
+			continue;
+		bool dashed = (e.dashed >= 0) ? e.dashed : edgeDashed;
+		snprintf(buf, sizeof(buf), "<line x1=\"%.1f\" y1=\"%.1f\" x2=\"%.1f\" y2=\"%.1f\" stroke=\"%s\" stroke-width=\"%d\"%s/>\n",
+			px(a), py(a), px(b), py(b), palette[e.color >= 0 ? e.color : edgeColor].c_str(),
+			e.thickness >= 0 ? e.thickness : 1, dashed ? " stroke-dasharray=\"4 3\"" : "");
+		out += buf;
+		drawnEdges++;
+	}
+	for (auto &n : nodes)
+	{
+		if (n.removed || (n.color < 0 && n.size < 0 && n.label.empty()))
+			continue;
+		snprintf(buf, sizeof(buf), "<circle cx=\"%.1f\" cy=\"%.1f\" r=\"%.1f\" fill=\"%s\"/>\n", px(n), py(n),
+			(n.size >= 0 ? n.size : nodeSize) / 10.0, palette[n.color >= 0 ? n.color : nodeColor].c_str());
+		out += buf;
+		drawnNodes++;
+	}
+	for (auto &n : nodes)
+	{
+		if (n.removed || n.label.empty())
+			continue;
+		snprintf(buf, sizeof(buf), "<text x=\"%.1f\" y=\"%.1f\" font-size=\"12\" font-family=\"sans-serif\">", px(n), py(n));
+		out += buf;
+		for (char c : n.label)
+		{
+			if (c == '<') out += "&lt;";
+			else if (c == '>') out += "&gt;";
+			else if (c == '&') out += "&amp;";
+			else out += c;
+		}
+		out += "</text>\n";
+	}
+	out += "</svg>\n";
+
+	ofstream file(path, ios::binary);
+	if (!file.is_open())
+		return false;
+	file.write(out.data(), out.size());
+	return file.good();
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "TravelTimeProfile.h"
+
+using namespace std;
+
+void TravelTimeProfile::addBreakpoint(double secondsOfDay, double factor)
+{
+	Breakpoint b;
+	b.minute = (uint16_t)((unsigned)(fmod(secondsOfDay, DAY) / 60) % (DAY / 60));
+	b.factor = (uint16_t)min(65535.0, max(1.0, round(factor * FACTOR_SCALE)));
+
+	// Manter ordenado por minuto, substituindo um breakpoint repetido
+	auto it = lower_bound(points.begin(), points.end(), b,
+		[](const Breakpoint &p, const Breakpoint &q) { return p.minute < q.minute; });
+	if (it != points.end() && it->minute == b.minute)
+		*it = b;
+	else
+		points.insert(it, b);
+}
+
+double TravelTimeProfile::factorAt(double seconds) const
+{
+	if (points.empty())
+		return 1;
+	if (points.size() == 1)
+		return points[0].factor / (double)FACTOR_SCALE;
+
+	double minute = fmod(seconds, DAY) / 60;
+	if (minute < 0)
+		minute += DAY / 60;
+
+	// Segmento [a, b] que contém o instante (com volta à meia-noite)
+	auto it = upper_bound(points.begin(), points.end(), minute,
+		[](double m, const Breakpoint &p) { return m < p.minute; });
+	const Breakpoint &b = (it == points.end()) ? points.front() : *it;
+	const Breakpoint &a = (it == points.begin()) ? points.back() : *(it - 1);
+
+	double span = b.minute - a.minute;
+	double offset = minute - a.minute;
+	if (span <= 0)
+		span += DAY / 60;
+	if (offset < 0)
+		offset += DAY / 60;
+
+	double fa = a.factor / (double)FACTOR_SCALE;
+	double fb = b.factor / (double)FACTOR_SCALE;
+	return fa + (fb - fa) * (offset / span);
+}
+
+double TravelTimeProfile::minFactor() const
+{
+	double res = points.empty() ? 1 : numeric_limits<double>::max();
+	for (auto &p : points)
+		res = min(res, p.factor / (double)FACTOR_SCALE);
+	return res;
+}
+
+double TravelTimeProfile::minSlope() const
+{
+	double res = 0;
+	for (size_t i = 0; i < points.size() && points.size() > 1; i++)
+	{
+		const Breakpoint &a = points[i];
+		const Breakpoint &b = points[(i + 1) % points.size()];
+		double span = b.minute - a.minute;
+		if (span <= 0)
+			span += DAY / 60;
+		double slope = (b.factor - (double)a.factor) / FACTOR_SCALE / (span * 60);
+		res = min(res, slope);
+	}
+	return res;
+}
+
+size_t TravelTimeProfile::memoryUsage() const
+{
+	return sizeof(*this) + points.capacity() * sizeof(Breakpoint);
+}
+
+TravelTimes::TravelTimes(double freeFlowSpeed) : speed(freeFlowSpeed)
+{
+	// Perfil 0: sem congestionamento
+	profiles.push_back(TravelTimeProfile());
+}
+
+int TravelTimes::addProfile(const TravelTimeProfile &profile)
+{
+	if (profiles.size() >= MAX_PROFILES)
+		return -1;
+	profiles.push_back(profile);
+	fastestFactor = min(fastestFactor, profile.minFactor());
+	return profiles.size() - 1;
+}
+
+void TravelTimes::setEdgeProfile(int edgeID, uint8_t profile)
+{
+	if (edgeID < 0 || profile >= profiles.size())
+		return;
+	if ((size_t)edgeID >= edgeProfile.size())
+		edgeProfile.resize(edgeID + 1, 0);
+	edgeProfile[edgeID] = profile;
+}
+
+/**
+ * Time needed to traverse an edge of the given length when entering it at "departure".
+ */
+double TravelTimes::travelTime(int edgeID, double length, double departure) const
+{
+	double base = length / speed;
+	if (edgeID < 0 || (size_t)edgeID >= edgeProfile.size())
+		return base;
+	return base * profiles[edgeProfile[edgeID]].factorAt(departure);
+}
+
+/**
+ * Admissible estimate of the travel time over a straight line (A* heuristic).
+ */
+double TravelTimes::lowerBound(double length) const
+{
+	return length / speed * fastestFactor;
+}
+
+/**
+ * FIFO holds if leaving later never means arriving earlier, i.e.
+ * base * factor'(t) >= -1 for the longest edge.
+ */
+bool TravelTimes::isFIFO(double maxLength) const
+{
+	double base = maxLength / speed;
+	for (auto &p : profiles)
+		if (base * p.minSlope() < -1)
+			return false;
+	return true;
+}
+
+size_t TravelTimes::memoryUsage() const
+{
+	size_t res = sizeof(*this) + edgeProfile.capacity() * sizeof(uint8_t);
+	for (auto &p : profiles)
+		res += p.memoryUsage();
+	return res;
+}
@@ -0,0 +1,136 @@
+#include "ViewerStub.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#ifdef linux
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+ViewerStub::ViewerStub(short port, unsigned long burst) : port(port), burst(burst), lines(0) {}
+
+ViewerStub::~ViewerStub() {
+  stop();
+}
+
+/*
+ * Starts listening and serves clients, one at a time, on a background thread.
+ */
+bool ViewerStub::start() {
+#ifdef linux
+  listenSock = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenSock < 0)
+    return false;
+
+  int yes = 1;
+  setsockopt(listenSock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (bind(listenSock, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(listenSock, 1) < 0) {
+    close(listenSock);
+    listenSock = -1;
+    return false;
+  }
+
+  server = thread(&ViewerStub::serve, this);
+  return true;
+#else
+  cerr << "ViewerStub is only available on linux" << endl;
+  return false;
+#endif
+}
+
+void ViewerStub::stop() {
+#ifdef linux
+  if (listenSock >= 0) {
+    shutdown(listenSock, SHUT_RDWR);
+    close(listenSock);
+    listenSock = -1;
+  }
+#endif
+  if (server.joinable())
+    server.join();
+}
+
+unsigned long ViewerStub::linesReceived() const {
+  return lines;
+}
+
+void ViewerStub::serve() {
+#ifdef linux
+  while (true) {
+    int client = accept(listenSock, nullptr, nullptr);
+    if (client < 0)
+      return;
+    if (burst > 0)
+      sendBurst(client);
+    else
+      serveClient(client);
+    close(client);
+  }
+#endif
+}
+
+/*
+ * Reads until the client closes the connection, answering every
+ * complete line with "ok" (replies for one read are sent together).
+ */
+void ViewerStub::serveClient(int client) {
+#ifdef linux
+  char buf[64 * 1024];
+  string replies;
+  while (true) {
+    ssize_t n = recv(client, buf, sizeof(buf), 0);
+    if (n <= 0)
+      return;
+    replies.clear();
+    for (ssize_t i = 0; i < n; i++)
+      if (buf[i] == '\n')
+        replies += "ok\n";
+    lines += replies.size() / 3;
+    size_t sent = 0;
+    while (sent < replies.size()) {
+      ssize_t res = send(client, replies.c_str() + sent, replies.size() - sent, MSG_NOSIGNAL);
+      if (res <= 0)
+        return;
+      sent += res;
+    }
+  }
+#else
+  (void) client;
+#endif
+}
+
+void ViewerStub::sendBurst(int client) {
+#ifdef linux
+  string chunk;
+  for (int i = 0; i < 4096; i++)
+    chunk += "ok\n";
+  unsigned long left = burst;
+  while (left > 0) {
+    size_t len = min<unsigned long>(left, 4096) * 3;
+    size_t sent = 0;
+    while (sent < len) {
+      ssize_t res = send(client, chunk.c_str() + sent, len - sent, MSG_NOSIGNAL);
+      if (res <= 0)
+        return;
+      sent += res;
+    }
+    left -= len / 3;
+  }
+#else
+  (void) client;
+#endif
+}
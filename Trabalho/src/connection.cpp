@@ -1,5 +1,7 @@
 #include "connection.h"
 
+#include <cerrno>
+
 void myerror(string msg) {
   printf("%s\n", msg.c_str());
   exit(-1);
@@ -53,7 +55,24 @@ Connection::Connection(short port) {
 #endif
 }
 
+Connection::~Connection() {
+  setPipelined(false);
+#ifdef linux
+  close(sock);
+#else
+  closesocket(sock);
+#endif
+}
+
 bool Connection::sendMsg(string msg) {
+  if (pipelined) {
+    outBuffer += msg;
+    buffered++;
+    if (outBuffer.size() >= BATCH_SIZE)
+      writeBatch();
+    return true;
+  }
+
   int res = send(sock, msg.c_str(), msg.size(), 0);
   if (res < 0) 
     myerror("Unable to send");
@@ -61,14 +80,172 @@ bool Connection::sendMsg(string msg) {
   return answer == "ok";
 }
 
+void Connection::setPipelined(bool on) {
+  if (on == pipelined)
+    return;
+  if (on) {
+    stopReader = false;
+    broken = false;
+    reader = thread(&Connection::readReplies, this);
+    pipelined = true;
+  }
+  else {
+    flush();
+    {
+      lock_guard<mutex> lock(mtx);
+      stopReader = true;
+    }
+    cv.notify_all();
+    reader.join();
+    pipelined = false;
+  }
+}
+
+bool Connection::isPipelined() const {
+  return pipelined;
+}
+
+/*
+ * Writes the buffered messages and waits until all of them were answered.
+ * Returns false if any reply since the last flush was not "ok".
+ */
+bool Connection::flush() {
+  if (!pipelined)
+    return true;
+  writeBatch();
+  unique_lock<mutex> lock(mtx);
+  cv.wait(lock, [this] { return replied == written || broken; });
+  bool ok = (failed == 0 && !broken);
+  failed = 0;
+  return ok;
+}
+
+void Connection::writeBatch() {
+  if (outBuffer.empty())
+    return;
+  // Count the messages first, so the reader already expects their replies
+  {
+    lock_guard<mutex> lock(mtx);
+    if (broken) {
+      outBuffer.clear();
+      buffered = 0;
+      return;
+    }
+    written += buffered;
+  }
+  cv.notify_all();
+  size_t sent = 0;
+  while (sent < outBuffer.size()) {
+    int res = send(sock, outBuffer.c_str() + sent, outBuffer.size() - sent, 0);
+    if (res < 0)
+      myerror("Unable to send");
+    sent += res;
+  }
+  outBuffer.clear();
+  buffered = 0;
+}
+
+/*
+ * Background thread (pipelined mode): reads one reply per written message.
+ */
+void Connection::readReplies() {
+  while (true) {
+    {
+      unique_lock<mutex> lock(mtx);
+      cv.wait(lock, [this] { return stopReader || replied < written; });
+      if (replied == written)
+        return;
+    }
+    string answer = readLine();
+    {
+      lock_guard<mutex> lock(mtx);
+      if (status != READ_OK) {
+        // No more replies will come: fail everything still pending
+        failed += written - replied;
+        replied = written;
+        broken = true;
+      }
+      else {
+        replied++;
+        if (answer != "ok")
+          failed++;
+      }
+    }
+    cv.notify_all();
+    if (broken)
+      return;
+  }
+}
+
 string Connection::readLine() {
-  string msg;  
-  char ch;
   while (true) {
-    recv(sock, &ch, 1, 0);
-    if (ch == '\n')
-      break;
-    msg.push_back(ch);
+    size_t pos = inBuffer.find('\n', inStart + scanned);
+    if (pos != string::npos) {
+      string msg = inBuffer.substr(inStart, pos - inStart);
+      inStart = pos + 1;
+      scanned = 0;
+      status = READ_OK;
+      return msg;
+    }
+    scanned = inBuffer.size() - inStart;
+    if (!fill())
+      return "";
+  }
+}
+
+/*
+ * Appends one recv() worth of data to inBuffer, dropping what was
+ * already consumed. Returns false (and sets status) on EOF/error/timeout.
+ */
+bool Connection::fill() {
+  if (inStart > 0) {
+    inBuffer.erase(0, inStart);
+    inStart = 0;
   }
-  return msg;
+  size_t old = inBuffer.size();
+  inBuffer.resize(old + RECV_SIZE);
+  int res;
+  do {
+    res = recv(sock, &inBuffer[old], RECV_SIZE, 0);
+    recvs++;
+#ifdef linux
+  } while (res < 0 && errno == EINTR);
+#else
+  } while (false);
+#endif
+  inBuffer.resize(old + (res > 0 ? res : 0));
+
+  if (res > 0)
+    return true;
+  if (res == 0)
+    status = READ_EOF;
+#ifdef linux
+  else if (errno == EAGAIN || errno == EWOULDBLOCK)
+#else
+  else if (WSAGetLastError() == WSAETIMEDOUT)
+#endif
+    status = READ_TIMEOUT;
+  else
+    status = READ_ERROR;
+  return false;
+}
+
+Connection::ReadStatus Connection::readStatus() const {
+  return status;
+}
+
+void Connection::setTimeout(int ms) {
+#ifdef linux
+  struct timeval tv;
+  tv.tv_sec = ms / 1000;
+  tv.tv_usec = (ms % 1000) * 1000;
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+#else
+  DWORD timeout = ms;
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char *) &timeout, sizeof(timeout));
+#endif
+}
+
+unsigned long Connection::recvCalls() const {
+  return recvs;
 }
@@ -97,7 +97,8 @@ bool GraphViewer::closeWindow()
 	char buff[200];
 	sprintf(buff, "closeWindow\n");
 	string str(buff);
-	return con->sendMsg(str);
+	bool ok = con->sendMsg(str);
+	return flush() && ok;
 }
 
 bool GraphViewer::addNode(int id)
@@ -367,5 +368,16 @@ bool GraphViewer::setEdgeFlow(int id, int flow)
 
 bool GraphViewer::rearrange()
 {
-	return con->sendMsg("rearrange\n");
+	bool ok = con->sendMsg("rearrange\n");
+	return flush() && ok;
+}
+
+void GraphViewer::setPipelined(bool on)
+{
+	con->setPipelined(on);
+}
+
+bool GraphViewer::flush()
+{
+	return con->flush();
 }
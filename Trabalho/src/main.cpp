@@ -8,10 +8,27 @@
 #include <vector>
 #include <map>
 #include <chrono>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#ifdef linux
+#include <sys/wait.h>
+#endif
 
 #include "Graph.h"
+#include "DynamicShortestPaths.h"
+#include "ChainCompression.h"
+#include "Landmarks.h"
+#include "DistanceField.h"
+#include "VertexOrdering.h"
 #include "graphviewer.h"
 #include "ParsingHelper.h"
+#include "SearchStats.h"
+#include "TravelTimeProfile.h"
+#include "ViewerStub.h"
+#include "SvgRenderer.h"
+#include "ViewerScene.h"
+#include "CoordinateStore.h"
 
 //ln -s /mnt/c/Program\ Files\ \(x86\)/Java/jre1.8.0_151/bin/java.exe /bin/java
 
@@ -29,6 +46,14 @@ const string PATH_DEFAULT_COLOR = BLUE;
 const int PATH_HIGHLIGHT_SIZE = 40;
 const int PATH_DEFAULT_SIZE = 10;
 
+const short VIEWER_STUB_PORT = 7700;		// servidor local de teste (ViewerStub)
+
+const double FREE_FLOW_SPEED = 50 / 3.6;	// m/s
+const double ARTERIAL_MIN_LENGTH = 100;		// arestas longas -> vias principais
+
+// Contadores de pesquisa agregados por operação (só com make STATS=1), um relatório por thread
+thread_local StatsReport searchStats;
+
 
 struct Node
 {
@@ -64,7 +89,8 @@ struct Route
 	Route(int ID, double totalDistance, vector<int> nodeIDs, vector<int> edgeIDs) : ID(ID), totalDistance(totalDistance), nodeIDs(nodeIDs), edgeIDs(edgeIDs) {}
 };
 
-void drawRoute(GraphViewer *gv, const Route& r)
+template <class Viewer>
+void drawRoute(Viewer *gv, const Route& r)
 {
 	for(auto& id : r.edgeIDs)
 	{
@@ -76,7 +102,8 @@ void drawRoute(GraphViewer *gv, const Route& r)
 	gv->rearrange();
 }
 
-void drawPackage(GraphViewer *gv, const Package& p)
+template <class Viewer>
+void drawPackage(Viewer *gv, const Package& p)
 {
 	int origID = p.orig->getInfo().id;
 	int destID = p.dest->getInfo().id;
@@ -94,7 +121,8 @@ void drawPackage(GraphViewer *gv, const Package& p)
 	gv->rearrange();
 }
 
-void clearPackage(GraphViewer *gv, const Package& p)
+template <class Viewer>
+void clearPackage(Viewer *gv, const Package& p)
 {
 	int origID = p.orig->getInfo().id;
 	int destID = p.dest->getInfo().id;
@@ -109,7 +137,38 @@ void clearPackage(GraphViewer *gv, const Package& p)
 	gv->rearrange();
 }
 
-int nodeFileToGraph(Graph<Node>& graph, const string &filePath)
+/**
+ * Lê apenas a 1ª linha de um ficheiro de nodes/edges (nº de elementos).
+ */
+unsigned readElementCount(const string &filePath)
+{
+	ifstream inputFile;
+	if (ParsingHelper::openFileRead(inputFile, filePath) == -1)
+		return 0;
+
+	string temp;
+	unsigned count;
+	getline(inputFile, temp);
+	if (!ParsingHelper::safeStoul(count, temp, 0, numeric_limits<unsigned>::max()))
+		return 0;
+	return count;
+}
+
+/**
+ * Coordenadas dos vértices em SoA, pela ordem dos índices do grafo.
+ */
+template <class Alloc>
+CoordinateStore coordinatesOf(const Graph<Node, Alloc>& graph)
+{
+	CoordinateStore coords;
+	coords.reserve(graph.getNumVertex());
+	for (int i = 0; i < graph.getNumVertex(); i++)
+		coords.add(graph.getVertex(i)->getInfo().x, graph.getVertex(i)->getInfo().y);
+	return coords;
+}
+
+template <class Alloc>
+int nodeFileToGraph(Graph<Node, Alloc>& graph, const string &filePath)
 {
 	ifstream inputFile;
 	if (ParsingHelper::openFileRead(inputFile, filePath) == -1)
@@ -165,7 +224,8 @@ int nodeFileToGraph(Graph<Node>& graph, const string &filePath)
 	return nodeCount;
 }
 
-int edgeFileToGraph(Graph<Node>& graph, const string &filePath)
+template <class Alloc>
+int edgeFileToGraph(Graph<Node, Alloc>& graph, const string &filePath)
 {
 	ifstream inputFile;
 	if (ParsingHelper::openFileRead(inputFile, filePath) == -1)
@@ -179,7 +239,12 @@ int edgeFileToGraph(Graph<Node>& graph, const string &filePath)
 	if (!ParsingHelper::safeStoul(edgeCount, temp, 0, numeric_limits<unsigned>::max()))
 		return -1;
 
-	int id = 0;
+	// 1ª passagem: ler pares e contar o grau de cada nó
+	vector<pair<int, int>> pairs;
+	unordered_map<int, unsigned> degree;
+	pairs.reserve(edgeCount);
+	degree.reserve(graph.getNumVertex());
+
 	char c;
 	while (inputFile.good())
 	{
@@ -198,28 +263,56 @@ int edgeFileToGraph(Graph<Node>& graph, const string &filePath)
 			cin.clear();
 			cin.ignore(numeric_limits<streamsize>::max(), '\n');
 		}
-		else 
-		{	
-			Vertex<Node> *vO, *vD;
-			Node n1, n2;
-			vO = graph.findVertex(orig);
-			vD = graph.findVertex(dest);
-			if(vO != nullptr && vD != nullptr)
-			{
-				n1 = vO->getInfo();
-				n2 = vD->getInfo();
-
-				double dx = n2.x - n1.x;
-				double dy = n2.y - n1.y;
-				double weight = sqrt(dx * dx + dy * dy);
-				graph.addEdge(n1, n2, weight, id++);
-				graph.addEdge(n2, n1, weight, id++);
-			}
-			else
-			{
-				std::cerr << "addEdge failed" << endl;
-			}
+		else if(ss)
+		{
+			pairs.push_back({orig, dest});
+			// Cada linha gera uma aresta em cada sentido
+			degree[orig]++;
+			degree[dest]++;
+		}
+	}
+
+	// Reservar listas de arestas (entrada e saída têm o mesmo grau)
+	for (auto &v : graph.getVertexSet())
+	{
+		auto it = degree.find(v->getInfo().id);
+		if (it != degree.end())
+			v->reserveEdges(it->second, it->second);
+	}
+
+	// Pesos de todas as arestas de uma vez, a partir das coordenadas (SoA)
+	CoordinateStore coords = coordinatesOf(graph);
+	unordered_map<int, uint32_t> indexOf;
+	indexOf.reserve(graph.getNumVertex());
+	for (unsigned i = 0; i < coords.size(); i++)
+		indexOf[graph.getVertex(i)->getInfo().id] = i;
+
+	vector<uint32_t> from, to;
+	from.reserve(pairs.size());
+	to.reserve(pairs.size());
+	for (auto &p : pairs)
+	{
+		auto o = indexOf.find(p.first);
+		auto d = indexOf.find(p.second);
+		if (o == indexOf.end() || d == indexOf.end())
+		{
+			std::cerr << "addEdge failed" << endl;
+			continue;
 		}
+		from.push_back(o->second);
+		to.push_back(d->second);
+	}
+	vector<double> weights(from.size());
+	coords.pairDistances(from.data(), to.data(), from.size(), weights.data());
+
+	// 2ª passagem: criar as arestas
+	int id = 0;
+	for (size_t k = 0; k < from.size(); k++)
+	{
+		Node n1 = graph.getVertex(from[k])->getInfo();
+		Node n2 = graph.getVertex(to[k])->getInfo();
+		graph.addEdge(n1, n2, weights[k], id++);
+		graph.addEdge(n2, n1, weights[k], id++);
 	}
 
 	inputFile.close();
@@ -227,34 +320,53 @@ int edgeFileToGraph(Graph<Node>& graph, const string &filePath)
 	return id;
 }
 
-void tryDistanceBasedConnectionsForInaccessibleNodes(Graph<Node>& graph, vector<Vertex<Node>*> zeroOut, vector<Vertex<Node>*> zeroIn, int& edgeCount)
+/**
+ * Reordena os vértices em memória ("hilbert" ou "bfs"; "file" mantém a ordem do ficheiro).
+ * Os ids OSM não mudam, mas os apontadores para vértices deixam de ser válidos.
+ */
+bool renumberVertices(Graph<Node>& graph, const string& order)
 {
-	for(auto& node : zeroOut)
-	{
-		double dst = INF;
-		double temp;
-		Vertex<Node>* closest = nullptr;
-		Node thisNode = node->getInfo();
+	if (order == "file")
+		return true;
 
+	if (order == "hilbert")
+		graph.renumber(hilbertOrder(graph, [](const Node& n) { return make_pair(n.x, n.y); }));
+	else if (order == "bfs")
+		graph.renumber(bfsOrder(graph, graph.findVertex( CENTRO_APOIO )->getIndex()));
+	else
+		return false;
 
-		for(auto& other : zeroIn)
-		{
-			Node otherNode = other->getInfo();
+	return true;
+}
 
-			if(thisNode == otherNode || other->getIngoing().size() != 0)
-				continue;
+void tryDistanceBasedConnectionsForInaccessibleNodes(Graph<Node>& graph, vector<Vertex<Node>*> zeroOut, vector<Vertex<Node>*> zeroIn, int& edgeCount)
+{
+	// Candidatos em SoA; os que já têm arestas de entrada ficam desactivados
+	CoordinateStore candidates;
+	candidates.reserve(zeroIn.size());
+	for(auto& other : zeroIn)
+	{
+		size_t i = candidates.add(other->getInfo().x, other->getInfo().y);
+		if(other->getIngoing().size() != 0)
+			candidates.disable(i);
+	}
 
-			temp = sqrt( pow(otherNode.x - thisNode.x, 2) + pow(otherNode.y - thisNode.y, 2) );
-			if(temp < dst && temp < 300)
-			{
-				dst = temp;
-				closest = other;
-			}
-		}
+	unordered_map<Vertex<Node>*, size_t> position;
+	for(size_t i = 0; i < zeroIn.size(); i++)
+		position[zeroIn[i]] = i;
 
-		if(closest != nullptr)
+	for(auto& node : zeroOut)
+	{
+		Node thisNode = node->getInfo();
+		auto it = position.find(node);
+		size_t self = (it == position.end()) ? candidates.size() : it->second;
+
+		double dst2;
+		size_t closest = candidates.argmin(thisNode.x, thisNode.y, self, dst2);
+		if(closest < candidates.size() && dst2 < 300 * 300)
 		{
-			graph.addEdge(thisNode, closest->getInfo(), dst, edgeCount++);
+			graph.addEdge(thisNode, zeroIn[closest]->getInfo(), sqrt(dst2), edgeCount++);
+			candidates.disable(closest);
 		}
 	}
 }
@@ -262,7 +374,6 @@ void tryDistanceBasedConnectionsForInaccessibleNodes(Graph<Node>& graph, vector<
 void removeDeadEnds(Graph<Node>& graph, queue<Vertex<Node>*> zeroOut)
 {
 	Vertex<Node>* current;
-	Vertex<Node>* next;
 
 	// Enquanto tiver nós na pilha
 	while (!zeroOut.empty())
@@ -277,10 +388,13 @@ void removeDeadEnds(Graph<Node>& graph, queue<Vertex<Node>*> zeroOut)
 		if(current->getOutgoing().size() > 0)
 			continue;
 
+		// copiar as origens, removeEdge altera a lista de ingoing edges
+		vector<Vertex<Node>*> origins;
 		for(auto& e : current->getIngoing())
-		{
-			next = e.getOrig();
+			origins.push_back(graph.getVertex(e.getOrig()));
 
+		for(auto& next : origins)
+		{
 			// adicionar à pilha as ingoing edges do nó
 			zeroOut.push(next);
 
@@ -331,6 +445,8 @@ void checkInaccessibleNodes(Graph<Node>& graph, int& edgeCount, bool tryCorrecti
 
 void generateRandomPackages(unsigned amount, vector<Package>& packages, int seed, Graph<Node>& graph, int& edgeCount, bool doRandomSeed, bool printInfo)
 {
+	StatsScope scope(graph.getStats(), searchStats, "generateRandomPackages");
+
 	// Vetor duplicado para retirar aleatoriamente ids de nós
 	size_t currShuffleID = 0;
 	vector<int> shuffledIDs;
@@ -422,11 +538,12 @@ void generateRandomPackages(unsigned amount, vector<Package>& packages, int seed
 	}
 }
 
-GraphViewer* drawGraph(const Graph<Node>& graph)
+/**
+ * Desenha o mapa num GraphViewer ou num SvgRenderer (mesmas funções).
+ */
+template <class Viewer>
+void drawMap(Viewer *gv, const Graph<Node>& graph)
 {
-	// Criar grafo
-	GraphViewer *gv = new GraphViewer(600, 600, false);
-	gv->createWindow(800, 600);
 	gv->defineVertexColor(NODE_DEFAULT_COLOR);
 	gv->defineVertexSize(NODE_DEFAULT_SIZE);
 	gv->defineEdgeColor(DARK_GRAY);
@@ -456,7 +573,21 @@ GraphViewer* drawGraph(const Graph<Node>& graph)
 	// Desenhar arestas
 	for(auto& v : graph.getVertexSet())
 		for (auto& e : v->getOutgoing())
-			gv->addEdge(e.getEdgeID(), v->getInfo().id, e.getDest()->getInfo().id, EdgeType::DIRECTED);
+			gv->addEdge(e.getEdgeID(), v->getInfo().id, graph.getVertex(e.getDest())->getInfo().id, EdgeType::DIRECTED);
+}
+
+GraphViewer* drawGraph(const Graph<Node>& graph)
+{
+	// Criar grafo
+	GraphViewer *gv = new GraphViewer(600, 600, false);
+	gv->createWindow(800, 600);
+
+	// Enviar os comandos em lotes; rearrange() espera pelas respostas
+	gv->setPipelined(true);
+	drawMap(gv, graph);
+
+	if(!gv->flush())
+		cerr << "GraphViewer: some commands failed while drawing the graph" << endl;
 
 	return gv;
 }
@@ -486,6 +617,8 @@ bool addRoute(const Graph<Node>& graph, vector<Route>& routes, const Node& orig,
 
 void prepareDeliveryRouteForDisplay(Graph<Node>& graph, vector<Route>& routes, vector<Node>& deliveryRoute)
 {
+	StatsScope scope(graph.getStats(), searchStats, "prepareDeliveryRouteForDisplay");
+
 	Node orig = graph.findVertex(CENTRO_APOIO)->getInfo();
 	Vertex<Node>* dest = graph.findVertex(deliveryRoute.at(0));
 	graph.dijkstraShortestPath(orig);
@@ -504,8 +637,65 @@ void prepareDeliveryRouteForDisplay(Graph<Node>& graph, vector<Route>& routes, v
 	addRoute(graph, routes, orig, dest->getInfo(), dest->getDist());
 }
 
-bool findSubOptimalDeliveryRoute(Graph<Node>& graph, vector<Node>& deliveryRoute, const vector<Package>& packages)
+/**
+ * Perfis de congestionamento para as horas de ponta.
+ * O mapa não tem tipo de via, por isso as arestas longas são tratadas como vias principais.
+ */
+TravelTimes buildRushHourTravelTimes(const Graph<Node>& graph, bool printInfo)
+{
+	TravelTimes times(FREE_FLOW_SPEED);
+
+	TravelTimeProfile urban;
+	urban.addBreakpoint(0 * 3600, 1.0);
+	urban.addBreakpoint(7 * 3600, 1.0);
+	urban.addBreakpoint(8.5 * 3600, 1.8);
+	urban.addBreakpoint(10 * 3600, 1.2);
+	urban.addBreakpoint(17 * 3600, 1.2);
+	urban.addBreakpoint(18.5 * 3600, 2.0);
+	urban.addBreakpoint(20 * 3600, 1.0);
+
+	TravelTimeProfile arterial;
+	arterial.addBreakpoint(0 * 3600, 1.0);
+	arterial.addBreakpoint(7 * 3600, 1.1);
+	arterial.addBreakpoint(8.5 * 3600, 2.5);
+	arterial.addBreakpoint(10 * 3600, 1.3);
+	arterial.addBreakpoint(17 * 3600, 1.3);
+	arterial.addBreakpoint(18.5 * 3600, 2.8);
+	arterial.addBreakpoint(20.5 * 3600, 1.0);
+
+	uint8_t urbanID = times.addProfile(urban);
+	uint8_t arterialID = times.addProfile(arterial);
+
+	double maxLength = 0;
+	for (auto& v : graph.getVertexSet())
+		for (auto& e : v->getOutgoing())
+		{
+			times.setEdgeProfile(e.getEdgeID(), (e.getWeight() >= ARTERIAL_MIN_LENGTH) ? arterialID : urbanID);
+			maxLength = max(maxLength, e.getWeight());
+		}
+
+	if(printInfo)
+	{
+		cout << "Travel time profiles: " << times.memoryUsage() << " bytes" << endl;
+		cout << "FIFO: " << (times.isFIFO(maxLength) ? "yes" : "NO") << endl;
+	}
+
+	return times;
+}
+
+/**
+ * Percorre sempre o ponto mais próximo. Com travelTimes, o custo é o tempo de viagem
+ * à hora a que se passa em cada aresta e "clock" avança ao longo da rota.
+ */
+bool findSubOptimalDeliveryRoute(Graph<Node>& graph, vector<Node>& deliveryRoute, const vector<Package>& packages,
+								const TravelTimes* travelTimes, double& clock)
 {
+	StatsScope scope(graph.getStats(), searchStats, "findSubOptimalDeliveryRoute");
+
+	auto travelTime = [travelTimes](const Edge<Node>& e, double t) {
+		return travelTimes->travelTime(e.getEdgeID(), e.getWeight(), t);
+	};
+
 	vector<Vertex<Node>*> remainingPoints;
 	map< Vertex<Node>*, Vertex<Node>* > pickUpDeliveryPairs;
 	for(auto &p : packages)
@@ -530,7 +720,10 @@ bool findSubOptimalDeliveryRoute(Graph<Node>& graph, vector<Node>& deliveryRoute
 		shortestDst2Curr = INF;
 
 		// Calcular caminhos a partir do ponto atual
-		graph.dijkstraShortestPath(current->getInfo());
+		if (travelTimes == nullptr)
+			graph.dijkstraShortestPath(current->getInfo());
+		else
+			graph.timeDependentShortestPath(current->getInfo(), clock, travelTime);
 
 		// Procurar o ponto mais próximo do atual
 		for(auto &node : remainingPoints)
@@ -547,6 +740,8 @@ bool findSubOptimalDeliveryRoute(Graph<Node>& graph, vector<Node>& deliveryRoute
 		if(shortestDst2Curr == INF)
 			break;
 
+		clock += shortestDst2Curr;
+
 		// Saltar se o ponto atual for o centro de apoio
 		if(current->getInfo().id == CENTRO_APOIO)
 			continue;
@@ -565,6 +760,18 @@ bool findSubOptimalDeliveryRoute(Graph<Node>& graph, vector<Node>& deliveryRoute
 	return (remainingPoints.size() == 0);
 }
 
+bool findSubOptimalDeliveryRoute(Graph<Node>& graph, vector<Node>& deliveryRoute, const vector<Package>& packages)
+{
+	double distance = 0;
+	return findSubOptimalDeliveryRoute(graph, deliveryRoute, packages, nullptr, distance);
+}
+
+bool findSubOptimalDeliveryRoute(Graph<Node>& graph, vector<Node>& deliveryRoute, const vector<Package>& packages,
+								const TravelTimes& travelTimes, double& clock)
+{
+	return findSubOptimalDeliveryRoute(graph, deliveryRoute, packages, &travelTimes, clock);
+}
+
 void testAverageRouteTime(Graph<Node>& graph, vector<Node>& deliveryRoute, vector<Package>& packages, 
 							unsigned amount, int seed, int& edgeCount)
 {
@@ -581,6 +788,7 @@ void testAverageRouteTime(Graph<Node>& graph, vector<Node>& deliveryRoute, vecto
 	cout << "-------- Delivery Route Finder --------" << endl;
 	long long avg = 0;
 	size_t iterations = 5;
+	searchStats.clear();
 
 	for (size_t i = 0; i < iterations; i++)
 	{
@@ -599,6 +807,7 @@ void testAverageRouteTime(Graph<Node>& graph, vector<Node>& deliveryRoute, vecto
 	cout << "Average time for " << iterations << " iterations: "
 			<< avg / (long double)iterations
 			<< " ms" << endl;
+	printStatsReport(cout, searchStats);
 }
 
 void testSingleRouteAndDraw(Graph<Node>& graph, vector<Node>& deliveryRoute, vector<Package>& packages, 
@@ -645,18 +854,189 @@ void testSingleRouteAndDraw(Graph<Node>& graph, vector<Node>& deliveryRoute, vec
 	}
 }
 
+/**
+ * Como testSingleRouteAndDraw, mas sem o GraphViewer (nem pausas): escreve
+ * o mapa, as encomendas e a rota num ficheiro SVG.
+ */
+void testSingleRouteAndRender(Graph<Node>& graph, vector<Node>& deliveryRoute, vector<Package>& packages,
+							unsigned amount, int seed, int& edgeCount, const string& svgPath)
+{
+	deliveryRoute.clear();
+	packages.clear();
+
+	generateRandomPackages(amount, packages, seed, graph, edgeCount, false, false);
+	if(packages.size() == 0)
+		return;
+
+	bool success = findSubOptimalDeliveryRoute(graph, deliveryRoute, packages);
+	cout << "-------- Delivery Route Finder --------" << endl;
+	cout << ((success) ? "Success" : "Fail") << endl;
+	cout << "-----------------------------------" << endl;
+
+	vector<Route> routes;
+	prepareDeliveryRouteForDisplay(graph, routes, deliveryRoute);
+
+	auto start = chrono::steady_clock::now();
+	SvgRenderer svg(1600, 1200);
+	drawMap(&svg, graph);
+
+	for(auto& p : packages)
+		drawPackage(&svg, p);
+
+	for(auto& r : routes)
+	{
+		svg.setVertexColor(r.nodeIDs.at(0), YELLOW);
+		svg.setVertexSize(r.nodeIDs.at(0), 100);
+		drawRoute(&svg, r);
+	}
+
+	bool written = svg.write(svgPath);
+	auto end = chrono::steady_clock::now();
+
+	cout << (written ? "Written " : "Failed to write ") << svgPath << " in "
+		<< chrono::duration_cast<chrono::milliseconds>(end - start).count() << " ms | edges drawn: "
+		<< svg.edgesDrawn() << " | merged: " << svg.edgesMerged() << " | nodes drawn: " << svg.nodesDrawn() << endl;
+}
+
+/**
+ * Tempo de render de uma grelha sintética com ~1M arestas (sem e com LOD).
+ */
+void testSvgRenderLarge(const string& svgPath)
+{
+	cout << "-------- SVG render (synthetic 1M edges) --------" << endl;
+	const int cols = 710, rows = 710;
+
+	for(double cell : { 0.0, 2.0 })
+	{
+		auto start = chrono::steady_clock::now();
+		SvgRenderer svg(1600, 1200);
+		svg.setCellSize(cell);
+		int edgeID = 0;
+		for(int y = 0; y < rows; y++)
+			for(int x = 0; x < cols; x++)
+			{
+				int id = y * cols + x;
+				svg.addNode(id, x * 10, y * 10);
+				if(x > 0)
+					svg.addEdge(edgeID++, id - 1, id, EdgeType::UNDIRECTED);
+				if(y > 0)
+					svg.addEdge(edgeID++, id - cols, id, EdgeType::UNDIRECTED);
+			}
+		bool written = svg.write(svgPath);
+		auto end = chrono::steady_clock::now();
+
+		cout << "LOD cell " << cell << " px | " << edgeID << " edges in "
+			<< chrono::duration_cast<chrono::milliseconds>(end - start).count() << " ms | edges drawn: "
+			<< svg.edgesDrawn() << (written ? "" : " | FAILED") << endl;
+	}
+}
+
+/**
+ * Comandos enviados ao viewer para desenhar o mapa, as encomendas e animar a
+ * rota: directamente, e através de uma ViewerScene (cadeias de grau 2
+ * colapsadas, só o viewport, só atributos alterados). O resultado da cena
+ * é escrito em SVG.
+ */
+void testViewerScene(Graph<Node>& graph, vector<Node>& deliveryRoute, vector<Package>& packages,
+							unsigned amount, int seed, int& edgeCount, const string& svgPath)
+{
+	deliveryRoute.clear();
+	packages.clear();
+
+	generateRandomPackages(amount, packages, seed, graph, edgeCount, false, false);
+	if(packages.size() == 0)
+		return;
+	findSubOptimalDeliveryRoute(graph, deliveryRoute, packages);
+
+	vector<Route> routes;
+	prepareDeliveryRouteForDisplay(graph, routes, deliveryRoute);
+
+	cout << "-------- Viewer scene (LOD / delta updates) --------" << endl;
+
+	// Sem cena: todos os comandos de drawGraph/drawPackage/drawRoute
+	unsigned long direct = 7 + graph.getNumVertex();
+	for(auto& v : graph.getVertexSet())
+	{
+		direct += v->getOutgoing().size();
+		if(v->getInfo().id == CENTRO_APOIO)
+			direct += 3;
+		if((v->getOutgoing().size() == 0) != (v->getIngoing().size() == 0))
+			direct++;
+	}
+	unsigned long directMap = direct;
+	direct += packages.size() * 9;
+	for(auto& r : routes)
+		direct += 3 + 3 * r.edgeIDs.size();
+
+	// Viewport: quarto central do mapa
+	double minX = INF, minY = INF, maxX = -INF, maxY = -INF;
+	for(auto& v : graph.getVertexSet())
+	{
+		minX = min(minX, v->getInfo().x);
+		maxX = max(maxX, v->getInfo().x);
+		minY = min(minY, -v->getInfo().y);
+		maxY = max(maxY, -v->getInfo().y);
+	}
+	double w = maxX - minX, h = maxY - minY;
+
+	for(bool viewport : { false, true })
+	{
+		SvgRenderer svg(1600, 1200);
+		ViewerScene<SvgRenderer> scene(&svg);
+		drawMap(&scene, graph);
+		unsigned chains = scene.collapseChains();
+		if(viewport)
+			scene.setViewport(minX + w / 4, minY + h / 4, maxX - w / 4, maxY - h / 4);
+		unsigned long first = scene.commit();
+
+		for(auto& p : packages)
+			drawPackage(&scene, p);
+
+		unsigned long maxFrame = 0;
+		for(auto& r : routes)
+		{
+			unsigned long before = scene.commandsSent();
+			scene.setVertexColor(r.nodeIDs.at(0), YELLOW);
+			scene.setVertexSize(r.nodeIDs.at(0), 100);
+			drawRoute(&scene, r);
+			maxFrame = max(maxFrame, scene.commandsSent() - before);
+		}
+
+		cout << (viewport ? "Central viewport" : "Whole map       ") << " | chains: " << chains
+			<< " | map: " << first << " commands (direct: " << directMap << ")"
+			<< " | total: " << scene.commandsSent() << " (direct: " << direct << ")"
+			<< " | largest route frame: " << maxFrame << endl;
+
+		if(viewport)
+			svg.write(svgPath);
+	}
+}
+
+/**
+ * Semente da execução "run" de uma experiência com semente base "seed".
+ * Cada execução tem o seu gerador, independente da ordem e da thread em que corre.
+ */
+int runSeed(int seed, unsigned run)
+{
+	seed_seq seq{ (unsigned)seed, run };
+	uint32_t out;
+	seq.generate(&out, &out + 1);
+	return (int)out;
+}
+
 long double testAverageRouteTimeWithRandomPackages(Graph<Node>& graph, vector<Node>& deliveryRoute, vector<Package>& packages, 
-							unsigned amount, int seed, int& edgeCount, bool printInfo)
+							unsigned amount, unsigned runs, int seed, int& edgeCount, bool printInfo)
 {
 	if(printInfo)
 		cout << "-------- Delivery Route Finder (random packages) --------" << endl;
-	long long avg2 = 0;
+	long double avg2 = 0;
+	searchStats.clear();
 
-	for (int i = 0; i < seed; i++)
+	for (unsigned i = 0; i < runs; i++)
 	{
 		packages.clear();
 
-		generateRandomPackages(amount, packages, seed, graph, edgeCount, true, false);
+		generateRandomPackages(amount, packages, runSeed(seed, i), graph, edgeCount, false, false);
 		if(packages.size() == 0)
 			return -1;
 
@@ -664,7 +1044,7 @@ long double testAverageRouteTimeWithRandomPackages(Graph<Node>& graph, vector<No
 		size_t iterations = 5;
 		bool success = false;
 
-		for (size_t i = 0; i < iterations; i++)
+		for (size_t it = 0; it < iterations; it++)
 		{
 			deliveryRoute.clear();
 			auto start = chrono::steady_clock::now();
@@ -684,14 +1064,935 @@ long double testAverageRouteTimeWithRandomPackages(Graph<Node>& graph, vector<No
 					<< " ms" << endl;		
 		}
 	}
-	avg2 = avg2 / (long double)seed;
+	avg2 = avg2 / (long double)runs;
 
 	if(printInfo)
-		cout << "Average time for " << seed << " iterations: " << avg2 << " ms" << endl;		
+	{
+		cout << "Average time for " << runs << " runs: " << avg2 << " ms" << endl;		
+		printStatsReport(cout, searchStats);
+	}
 
 	return avg2;
 }
 
+/**
+ * Copia os vértices (pela mesma ordem de índices) e as arestas (mesmos IDs) para um grafo vazio.
+ */
+void copyGraph(const Graph<Node>& src, Graph<Node>& dst)
+{
+	size_t edges = 0;
+	for (int i = 0; i < src.getNumVertex(); i++)
+		edges += src.getVertex(i)->getOutgoing().size();
+	dst.reserve(src.getNumVertex(), edges);
+
+	for (int i = 0; i < src.getNumVertex(); i++)
+		dst.addVertex(src.getVertex(i)->getInfo());
+	for (int i = 0; i < src.getNumVertex(); i++)
+	{
+		Vertex<Node>* v = src.getVertex(i);
+		dst.getVertex(i)->reserveEdges(v->getOutgoing().size(), v->getIngoing().size());
+	}
+	for (int i = 0; i < src.getNumVertex(); i++)
+		for (auto& e : src.getVertex(i)->getOutgoing())
+			dst.addEdge(src.getVertex(i)->getInfo(), src.getVertex(e.getDest())->getInfo(), e.getWeight(), e.getEdgeID());
+}
+
+/**
+ * Comprimento (m) da rota centro -> pontos -> centro, pelos caminhos mais curtos.
+ */
+double deliveryRouteLength(Graph<Node>& graph, const vector<Node>& deliveryRoute)
+{
+	Node centro = graph.findVertex( CENTRO_APOIO )->getInfo();
+	vector<Node> stops = { centro };
+	stops.insert(stops.end(), deliveryRoute.begin(), deliveryRoute.end());
+	stops.push_back(centro);
+
+	double length = 0;
+	for (size_t i = 0; i + 1 < stops.size(); i++)
+	{
+		graph.dijkstraShortestPath(stops[i]);
+		double leg = graph.findVertex(stops[i + 1])->getDist();
+		if (leg == INF)
+			return INF;
+		length += leg;
+	}
+	return length;
+}
+
+/*
+ * Uma execução da grelha sementes x nº de encomendas x algoritmo.
+ */
+struct ExperimentRun
+{
+	int seed;
+	unsigned packages;
+	string algorithm;
+	bool success = false;
+	double cost = 0;			// o que o algoritmo minimiza (m ou s)
+	double length = 0;			// comprimento da rota (m)
+	double elapsedMs = 0;		// média das repetições
+};
+
+/*
+ * Algoritmos comparados: vizinho mais próximo por distância e por tempo de viagem
+ * às horas de ponta (departure < 0: distância).
+ */
+struct RouteAlgorithm
+{
+	string name;
+	double departure;
+};
+
+/**
+ * Corre a grelha sementes x nº de encomendas x algoritmo em "threads" threads (0: uma por core).
+ * Cada thread tem a sua cópia do grafo (as pesquisas guardam dist/path nos vértices);
+ * as encomendas de cada execução dependem só da sua semente, por isso os resultados
+ * não dependem do nº de threads nem da ordem em que as execuções correm.
+ */
+vector<ExperimentRun> runRouteExperiments(const Graph<Node>& graph, const vector<int>& seeds, const vector<unsigned>& amounts,
+										const vector<RouteAlgorithm>& algorithms, unsigned repetitions, unsigned threads, int edgeCount)
+{
+	vector<ExperimentRun> runs;
+	for (int s : seeds)
+		for (unsigned a : amounts)
+			for (auto& alg : algorithms)
+			{
+				ExperimentRun r;
+				r.seed = s;
+				r.packages = a;
+				r.algorithm = alg.name;
+				runs.push_back(r);
+			}
+
+	if (threads == 0)
+		threads = max(1u, thread::hardware_concurrency());
+
+	// As pesquisas contam em searchStats, que é de cada thread: cada worker começa com ele
+	// vazio e guarda-o no seu relatório; o do chamador é posto de lado e somado no fim
+	unsigned workerCount = max<size_t>(1, min<size_t>(threads, runs.size()));
+	vector<StatsReport> workerStats(workerCount);
+	StatsReport callerStats;
+	callerStats.swap(searchStats);
+	atomic<size_t> next(0);
+	auto worker = [&](unsigned w) {
+		Graph<Node> workspace;
+		copyGraph(graph, workspace);
+		TravelTimes times = buildRushHourTravelTimes(workspace, false);
+		searchStats.clear();
+
+		vector<Package> packages;
+		vector<Node> deliveryRoute;
+		for (size_t task; (task = next++) < runs.size(); )
+		{
+			ExperimentRun& r = runs[task];
+			const RouteAlgorithm& alg = algorithms[task % algorithms.size()];
+
+			int packageEdges = edgeCount;
+			packages.clear();
+			generateRandomPackages(r.packages, packages, r.seed, workspace, packageEdges, false, false);
+
+			for (unsigned rep = 0; rep < repetitions; rep++)
+			{
+				deliveryRoute.clear();
+				double clock = max(alg.departure, 0.0);
+				auto start = chrono::steady_clock::now();
+				if (alg.departure < 0)
+					r.success = findSubOptimalDeliveryRoute(workspace, deliveryRoute, packages, nullptr, clock);
+				else
+					r.success = findSubOptimalDeliveryRoute(workspace, deliveryRoute, packages, times, clock);
+				auto end = chrono::steady_clock::now();
+				r.elapsedMs += chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0 / repetitions;
+				r.cost = clock - max(alg.departure, 0.0);
+			}
+			r.length = deliveryRouteLength(workspace, deliveryRoute);
+		}
+
+		workerStats[w].swap(searchStats);
+	};
+
+	vector<thread> pool;
+	for (unsigned w = 1; w < workerCount; w++)
+		pool.emplace_back(worker, w);
+	worker(0);
+	for (auto& t : pool)
+		t.join();
+
+	searchStats.swap(callerStats);
+	for (auto& report : workerStats)
+		for (auto& entry : report)
+			searchStats[entry.first] += entry.second;
+
+	return runs;
+}
+
+bool writeExperimentsCSV(const vector<ExperimentRun>& runs, const string& filePath)
+{
+	ofstream out(filePath);
+	if (!out)
+		return false;
+	out << "seed,packages,algorithm,success,cost,length_m,time_ms" << endl;
+	out.precision(10);
+	for (auto& r : runs)
+		out << r.seed << "," << r.packages << "," << r.algorithm << "," << r.success << ","
+			<< r.cost << "," << r.length << "," << r.elapsedMs << endl;
+	return (bool)out;
+}
+
+void testRouteExperiments(const Graph<Node>& graph, unsigned seedCount, int seed, int edgeCount, const string& csvPath)
+{
+	cout << "-------- Route experiments (seeds x packages x algorithm) --------" << endl;
+	vector<int> seeds;
+	for (unsigned i = 0; i < seedCount; i++)
+		seeds.push_back(runSeed(seed, i));
+	vector<unsigned> amounts = { 5, 10, 20 };
+	vector<RouteAlgorithm> algorithms = {
+		{ "nearest-distance", -1 },
+		{ "nearest-time-08h", 8 * 3600 },
+		{ "nearest-time-18h", 18 * 3600 }
+	};
+	unsigned cores = max(1u, thread::hardware_concurrency());
+	searchStats.clear();
+
+	auto t0 = chrono::steady_clock::now();
+	vector<ExperimentRun> runs = runRouteExperiments(graph, seeds, amounts, algorithms, 3, cores, edgeCount);
+	auto t1 = chrono::steady_clock::now();
+	// Os resultados (não os tempos) têm de ser os mesmos com outro nº de threads
+	vector<ExperimentRun> check = runRouteExperiments(graph, seeds, amounts, algorithms, 1, cores + 1, edgeCount);
+
+	unsigned differences = 0;
+	for (size_t i = 0; i < runs.size(); i++)
+		if (runs[i].success != check[i].success || runs[i].cost != check[i].cost || runs[i].length != check[i].length)
+			differences++;
+	cout << runs.size() << " runs | " << cores << " threads: " << chrono::duration_cast<chrono::milliseconds>(t1 - t0).count()
+		<< " ms | results differing with " << cores + 1 << " threads: " << differences << endl;
+
+	for (unsigned a : amounts)
+		for (auto& alg : algorithms)
+		{
+			unsigned n = 0, ok = 0;
+			double length = 0, time = 0;
+			for (auto& r : runs)
+				if (r.packages == a && r.algorithm == alg.name)
+				{
+					n++;
+					ok += r.success;
+					length += r.length;
+					time += r.elapsedMs;
+				}
+			cout << a << " packages | " << alg.name << " | success " << ok << "/" << n
+				<< " | mean length: " << length / n / 1000 << " km | mean time: " << time / n << " ms" << endl;
+		}
+
+	if (!writeExperimentsCSV(runs, csvPath))
+		cerr << "Unable to write " << csvPath << endl;
+	printStatsReport(cout, searchStats);
+}
+
+void testRushHourRoutes(Graph<Node>& graph, vector<Node>& deliveryRoute, vector<Package>& packages, 
+							unsigned amount, int seed, int& edgeCount)
+{
+	packages.clear();
+
+	generateRandomPackages(amount, packages, seed, graph, edgeCount, false, true);
+	if(packages.size() == 0)
+		return;
+
+	TravelTimes times = buildRushHourTravelTimes(graph, true);
+
+	cout << "-------- Delivery Route Finder (time-dependent) --------" << endl;
+	double departures[] = { 3 * 3600, 8 * 3600, 13 * 3600, 18 * 3600 };
+	for (double departure : departures)
+	{
+		deliveryRoute.clear();
+		double clock = departure;
+		auto start = chrono::steady_clock::now();
+		bool success = findSubOptimalDeliveryRoute(graph, deliveryRoute, packages, times, clock);
+		auto end = chrono::steady_clock::now();
+
+		cout << "Departure " << departure / 3600 << "h - " << ((success) ? "Success  |  " : "Fail  |  ");
+		cout << "Travel time: " << (clock - departure) / 60 << " min  |  ";
+		cout << "Elapsed time : " << chrono::duration_cast<chrono::milliseconds>(end - start).count() << " ms" << endl;
+	}
+
+	// A* ponto a ponto com a mesma hora de partida
+	Vertex<Node>* orig = packages.front().orig;
+	Vertex<Node>* dest = packages.front().dest;
+	Node destNode = dest->getInfo();
+	auto travelTime = [&times](const Edge<Node>& e, double t) {
+		return times.travelTime(e.getEdgeID(), e.getWeight(), t);
+	};
+	// Distâncias euclidianas ao destino calculadas de uma vez; a heurística só consulta a tabela
+	vector<double> toDest(graph.getNumVertex());
+	coordinatesOf(graph).distances(destNode.x, destNode.y, toDest.data());
+	auto heuristic = [&times, &toDest](const Vertex<Node>* v) {
+		return times.lowerBound(toDest[v->getIndex()]);
+	};
+
+	for (double departure : departures)
+	{
+		auto start = chrono::steady_clock::now();
+		graph.timeDependentShortestPath(orig->getInfo(), departure, travelTime);
+		auto end = chrono::steady_clock::now();
+		double dijkstraTime = dest->getDist();
+		long long dijkstraUs = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+		start = chrono::steady_clock::now();
+		graph.timeDependentAStar(orig->getInfo(), destNode, departure, travelTime, heuristic);
+		end = chrono::steady_clock::now();
+
+		cout << "Package 0 at " << departure / 3600 << "h: " << dest->getDist() / 60 << " min"
+			<< ((fabs(dijkstraTime - dest->getDist()) < 1e-6) ? "" : " (differs from Dijkstra)")
+			<< "  |  Dijkstra " << dijkstraUs << " us, A* "
+			<< chrono::duration_cast<chrono::microseconds>(end - start).count() << " us" << endl;
+	}
+}
+
+/**
+ * Memória residente do processo (bytes), 0 se não disponível.
+ */
+size_t residentMemory()
+{
+#ifdef linux
+	ifstream statm("/proc/self/statm");
+	size_t pages = 0, resident = 0;
+	statm >> pages >> resident;
+	return resident * sysconf(_SC_PAGESIZE);
+#else
+	return 0;
+#endif
+}
+
+template <class Alloc>
+void loadAndMeasure(const string& name, const string& nodePath, const string& edgePath)
+{
+	size_t rssBefore = residentMemory();
+	auto start = chrono::steady_clock::now();
+	{
+		Graph<Node, Alloc> graph;
+		graph.reserve(readElementCount(nodePath), 2 * readElementCount(edgePath));
+		nodeFileToGraph(graph, nodePath);
+		edgeFileToGraph(graph, edgePath);
+		auto end = chrono::steady_clock::now();
+		size_t rssAfter = residentMemory();
+
+		cout << name << " | load: " << chrono::duration_cast<chrono::milliseconds>(end - start).count() << " ms"
+			<< " | resident: " << (rssAfter - rssBefore) / 1024 << " KiB";
+
+		// Dijkstra sobre vértices contíguos vs dispersos
+		Node centro = graph.findVertex( CENTRO_APOIO )->getInfo();
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < 10; i++)
+			graph.dijkstraShortestPath(centro);
+		end = chrono::steady_clock::now();
+		cout << " | dijkstra: " << chrono::duration_cast<chrono::microseconds>(end - start).count() / 10 << " us";
+
+		start = chrono::steady_clock::now();
+	}
+	auto end = chrono::steady_clock::now();
+	cout << " | teardown: " << chrono::duration_cast<chrono::microseconds>(end - start).count() << " us" << endl;
+}
+
+void testGraphLoad(const string& nodePath, const string& edgePath)
+{
+	cout << "-------- Graph load (allocation policies) --------" << endl;
+
+#ifdef linux
+	// Cada medição corre num processo novo para a memória residente não ser partilhada
+	if (fork() == 0) { loadAndMeasure<HeapPolicy>("Heap ", nodePath, edgePath); exit(0); }
+	wait(nullptr);
+	if (fork() == 0) { loadAndMeasure<ArenaPolicy>("Arena", nodePath, edgePath); exit(0); }
+	wait(nullptr);
+#else
+	loadAndMeasure<HeapPolicy>("Heap ", nodePath, edgePath);
+	loadAndMeasure<ArenaPolicy>("Arena", nodePath, edgePath);
+#endif
+}
+
+void testEdgeLayout(Graph<Node>& graph)
+{
+	cout << "-------- Edge layout --------" << endl;
+
+	typedef decay<decltype(graph.getVertexSet().front()->getOutgoing())>::type::value_type OutEdge;
+	typedef decay<decltype(graph.getVertexSet().front()->getIngoing())>::type::value_type InEdge;
+
+	size_t edges = 0;
+	size_t bytes = 0;
+	for (auto& v : graph.getVertexSet())
+	{
+		edges += v->getOutgoing().size();
+		bytes += v->getOutgoing().capacity() * sizeof(OutEdge) + v->getIngoing().capacity() * sizeof(InEdge);
+	}
+
+	cout << "sizeof outgoing entry: " << sizeof(OutEdge) << " bytes" << endl;
+	cout << "sizeof ingoing entry: " << sizeof(InEdge) << " bytes" << endl;
+	cout << "Edge storage: " << bytes << " bytes for " << edges << " edges ("
+		<< bytes / (double)edges << " bytes per edge)" << endl;
+
+	Node centro = graph.findVertex( CENTRO_APOIO )->getInfo();
+	int runs = 50;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < runs; i++)
+		graph.dijkstraShortestPath(centro);
+	auto end = chrono::steady_clock::now();
+	cout << "Average dijkstraShortestPath time: "
+		<< chrono::duration_cast<chrono::microseconds>(end - start).count() / (long double)runs << " us" << endl;
+}
+
+void testRoadClosures(Graph<Node>& graph, unsigned closures, int seed)
+{
+	cout << "-------- Road closures (dynamic shortest paths) --------" << endl;
+
+	Node centro = graph.findVertex( CENTRO_APOIO )->getInfo();
+
+	auto start = chrono::steady_clock::now();
+	DynamicShortestPaths<Node> tree(graph, centro);
+	auto end = chrono::steady_clock::now();
+	cout << "Initial tree: " << chrono::duration_cast<chrono::microseconds>(end - start).count() << " us" << endl;
+
+	// Escolher arestas da árvore do centro de apoio para fechar
+	vector<Vertex<Node>*> reachable;
+	for (auto& v : graph.getVertexSet())
+		if (v->getInfo().id != CENTRO_APOIO && tree.getDist(v->getInfo()) != INF)
+			reachable.push_back(v);
+	if (reachable.empty())
+		return;
+
+	mt19937 g(seed);
+	uniform_int_distribution<size_t> pick(0, reachable.size() - 1);
+
+	long long repairTotal = 0;
+	long long fullTotal = 0;
+	unsigned long long updatedTotal = 0;
+	unsigned mismatches = 0;
+
+	// Compara a árvore mantida com um dijkstraShortestPath completo
+	auto compare = [&]() {
+		auto s = chrono::steady_clock::now();
+		graph.dijkstraShortestPath(centro);
+		auto e = chrono::steady_clock::now();
+		fullTotal += chrono::duration_cast<chrono::microseconds>(e - s).count();
+		for (auto& v : graph.getVertexSet())
+		{
+			double d1 = v->getDist();
+			double d2 = tree.getDist(v->getInfo());
+			if ((d1 == INF) != (d2 == INF) || (d1 != INF && fabs(d1 - d2) > 1e-6))
+				mismatches++;
+		}
+	};
+
+	for (unsigned i = 0; i < closures; i++)
+	{
+		vector<Node> path = tree.getPath(reachable.at(pick(g))->getInfo());
+		if (path.size() < 2)
+			continue;
+		Node orig = path.at(path.size() - 2);
+		Node dest = path.back();
+
+		double weight = 0;
+		int edgeID = -1;
+		for (auto& e : graph.findVertex(orig)->getOutgoing())
+			if (graph.getVertex(e.getDest())->getInfo().id == dest.id)
+			{
+				weight = e.getWeight();
+				edgeID = e.getEdgeID();
+				break;
+			}
+
+		// Fechar a estrada
+		auto s = chrono::steady_clock::now();
+		unsigned updated = tree.removeEdge(orig, dest);
+		auto e = chrono::steady_clock::now();
+		repairTotal += chrono::duration_cast<chrono::microseconds>(e - s).count();
+		updatedTotal += updated;
+		cout << "Close " << orig.id << " -> " << dest.id << " | updated: " << updated
+			<< " | repair: " << chrono::duration_cast<chrono::microseconds>(e - s).count() << " us" << endl;
+		compare();
+
+		// Reabrir a estrada
+		s = chrono::steady_clock::now();
+		updated = tree.insertEdge(orig, dest, weight, edgeID);
+		e = chrono::steady_clock::now();
+		repairTotal += chrono::duration_cast<chrono::microseconds>(e - s).count();
+		updatedTotal += updated;
+		cout << "Open  " << orig.id << " -> " << dest.id << " | updated: " << updated
+			<< " | repair: " << chrono::duration_cast<chrono::microseconds>(e - s).count() << " us" << endl;
+		compare();
+	}
+
+	cout << "-----------------------------------" << endl;
+	cout << "Updates: " << 2 * closures << " | vertices updated: " << updatedTotal << endl;
+	cout << "Average repair time: " << repairTotal / (long double)(2 * closures) << " us" << endl;
+	cout << "Average full dijkstraShortestPath time: " << fullTotal / (long double)(2 * closures) << " us" << endl;
+	cout << ((mismatches == 0) ? "Trees match" : "Trees differ") << " (" << mismatches << " mismatches)" << endl;
+}
+
+/**
+ * Distância média (em índices) entre os extremos de cada aresta e desempenho do Dijkstra.
+ */
+void measureVertexOrder(Graph<Node>& graph, const string& name)
+{
+	double span = 0;
+	size_t edges = 0;
+	for (auto& v : graph.getVertexSet())
+		for (auto& e : v->getOutgoing())
+		{
+			span += abs((long)v->getIndex() - (long)e.getDest());
+			edges++;
+		}
+
+	Node centro = graph.findVertex( CENTRO_APOIO )->getInfo();
+	int runs = 50;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < runs; i++)
+		graph.dijkstraShortestPath(centro);
+	auto end = chrono::steady_clock::now();
+
+	size_t settled = 0;
+	for (auto& v : graph.getVertexSet())
+		if (v->getDist() != INF)
+			settled++;
+
+	long double us = chrono::duration_cast<chrono::microseconds>(end - start).count() / (long double)runs;
+	cout << name << " | mean edge span: " << span / edges << " | dijkstra: " << us << " us"
+		<< " | settled/us: " << settled / us << endl;
+}
+
+void testVertexOrders(Graph<Node>& graph)
+{
+	cout << "-------- Vertex orders --------" << endl;
+	measureVertexOrder(graph, "File order");
+	renumberVertices(graph, "hilbert");
+	measureVertexOrder(graph, "Hilbert   ");
+	renumberVertices(graph, "bfs");
+	measureVertexOrder(graph, "BFS       ");
+}
+
+/**
+ * Envia os comandos de desenho do grafo (addNode/addEdge) a um servidor local
+ * que responde "ok" a cada linha, em modo síncrono e em modo pipelined.
+ * Mede o débito da ligação sem depender do GraphViewer em Java.
+ */
+void testViewerPipeline(const Graph<Node>& graph)
+{
+	cout << "-------- GraphViewer pipeline --------" << endl;
+	ViewerStub stub(VIEWER_STUB_PORT);
+	if(!stub.start())
+	{
+		cerr << "Unable to start the viewer stub on port " << VIEWER_STUB_PORT << endl;
+		return;
+	}
+
+	vector<string> commands;
+	char buff[200];
+	for(auto& v : graph.getVertexSet())
+	{
+		sprintf(buff, "addNode3 %d %d %d\n", v->getInfo().id, (int)v->getInfo().x, (int)-v->getInfo().y);
+		commands.push_back(buff);
+	}
+	for(auto& v : graph.getVertexSet())
+		for (auto& e : v->getOutgoing())
+		{
+			sprintf(buff, "addEdge %d %d %d %d\n", e.getEdgeID(), v->getInfo().id, graph.getVertex(e.getDest())->getInfo().id, EdgeType::DIRECTED);
+			commands.push_back(buff);
+		}
+
+	for(bool pipelined : { false, true })
+	{
+		Connection con(VIEWER_STUB_PORT);
+		con.setPipelined(pipelined);
+		bool ok = true;
+
+		auto start = chrono::steady_clock::now();
+		for(auto& c : commands)
+			ok = con.sendMsg(c) && ok;
+		ok = con.flush() && ok;
+		auto end = chrono::steady_clock::now();
+
+		long double ms = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0L;
+		cout << (pipelined ? "Pipelined" : "Sync     ") << " | " << commands.size() << " commands in " << ms << " ms"
+			<< " | " << commands.size() / ms * 1000 << " commands/s" << (ok ? "" : " | FAILED") << endl;
+	}
+
+	stub.stop();
+	cout << stub.linesReceived() << " lines received by the stub." << endl;
+}
+
+/**
+ * Lê "lines" respostas "ok" enviadas de uma vez por um servidor local, até
+ * ao fim da ligação. Mede linhas/s e chamadas a recv() por linha.
+ */
+void testConnectionReader(unsigned long lines)
+{
+	cout << "-------- Connection reader --------" << endl;
+	ViewerStub stub(VIEWER_STUB_PORT, lines);
+	if(!stub.start())
+	{
+		cerr << "Unable to start the viewer stub on port " << VIEWER_STUB_PORT << endl;
+		return;
+	}
+
+	unsigned long count = 0, bad = 0;
+	Connection::ReadStatus status;
+	long double ms;
+	unsigned long recvs;
+	{
+		Connection con(VIEWER_STUB_PORT);
+		con.setTimeout(5000);
+
+		auto start = chrono::steady_clock::now();
+		while(true)
+		{
+			string line = con.readLine();
+			if(con.readStatus() != Connection::READ_OK)
+				break;
+			if(line != "ok")
+				bad++;
+			count++;
+		}
+		auto end = chrono::steady_clock::now();
+
+		status = con.readStatus();
+		recvs = con.recvCalls();
+		ms = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0L;
+	}
+	stub.stop();
+
+	cout << count << "/" << lines << " lines in " << ms << " ms | " << count / ms * 1000 << " lines/s"
+		<< " | recv calls per line: " << recvs / (double)max(count, 1ul) << endl;
+	cout << "Ended with " << (status == Connection::READ_EOF ? "EOF" : "error/timeout")
+		<< (bad ? " | unexpected lines: " + to_string(bad) : "") << endl;
+}
+
+/**
+ * Contração das cadeias de grau 2: redução de vértices/arestas e tempo do
+ * Dijkstra (a partir de "sources" origens aleatórias) no grafo original e no
+ * comprimido. Confirma distâncias e caminhos (expandidos) para todos os destinos.
+ */
+void testChainCompression(Graph<Node>& graph, unsigned sources, int seed)
+{
+	cout << "-------- Degree-2 chain compression --------" << endl;
+	auto start = chrono::steady_clock::now();
+	ChainCompressedGraph<Node> compressed(graph);
+	auto end = chrono::steady_clock::now();
+
+	size_t edges = 0;
+	for (auto& v : graph.getVertexSet())
+		edges += v->getOutgoing().size();
+	cout << "Build: " << chrono::duration_cast<chrono::microseconds>(end - start).count() << " us | chains: " << compressed.getNumChains() << endl;
+	cout << "Vertices: " << graph.getNumVertex() << " -> " << compressed.getNumVertex()
+		<< " (" << 100.0 * compressed.getNumVertex() / graph.getNumVertex() << "%)" << endl;
+	cout << "Edges: " << edges << " -> " << compressed.getNumEdges()
+		<< " (" << 100.0 * compressed.getNumEdges() / edges << "%)" << endl;
+
+	mt19937 g(seed);
+	uniform_int_distribution<int> pick(0, graph.getNumVertex() - 1);
+
+	unordered_map<int, Vertex<Node>*> byID;
+	for (auto& v : graph.getVertexSet())
+		byID[v->getInfo().id] = v;
+
+	long long fullTotal = 0, compressedTotal = 0;
+	unsigned mismatches = 0, badPaths = 0;
+	vector<Node> nodes;
+	vector<int> edgeIDs;
+	for (unsigned i = 0; i < sources; i++)
+	{
+		Node s = graph.getVertex(pick(g))->getInfo();
+
+		auto t0 = chrono::steady_clock::now();
+		graph.dijkstraShortestPath(s);
+		auto t1 = chrono::steady_clock::now();
+		compressed.dijkstraShortestPath(s);
+		auto t2 = chrono::steady_clock::now();
+		fullTotal += chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+		compressedTotal += chrono::duration_cast<chrono::microseconds>(t2 - t1).count();
+
+		for (auto& v : graph.getVertexSet())
+		{
+			double d1 = v->getDist();
+			double d2 = compressed.getDist(v->getInfo());
+			if ((d1 == INF) != (d2 == INF) || (d1 != INF && fabs(d1 - d2) > 1e-6 * max(1.0, d1)))
+			{
+				mismatches++;
+				continue;
+			}
+			if (d1 == INF)
+				continue;
+
+			// O caminho expandido tem de usar arestas reais e somar a distância
+			compressed.getPath(v->getInfo(), nodes, edgeIDs);
+			double length = 0;
+			bool valid = nodes.size() == edgeIDs.size() + 1 && nodes.front().id == s.id && nodes.back().id == v->getInfo().id;
+			for (size_t k = 0; valid && k < edgeIDs.size(); k++)
+			{
+				valid = false;
+				for (auto& e : byID[nodes[k].id]->getOutgoing())
+					if (e.getEdgeID() == edgeIDs[k] && graph.getVertex(e.getDest())->getInfo().id == nodes[k + 1].id)
+					{
+						length += e.getWeight();
+						valid = true;
+						break;
+					}
+			}
+			if (!valid || fabs(length - d1) > 1e-6 * max(1.0, d1))
+				badPaths++;
+		}
+	}
+
+	cout << "Dijkstra (" << sources << " sources): original " << fullTotal / (double)sources << " us | compressed "
+		<< compressedTotal / (double)sources << " us | speedup: " << fullTotal / (double)max(compressedTotal, 1LL) << "x" << endl;
+	cout << "Distance mismatches: " << mismatches << " | invalid paths: " << badPaths << endl;
+}
+
+/**
+ * Pré-processamento ALT (FARTHEST e AVOID, com 1 thread e com todas) e
+ * pesquisas ponto a ponto: Dijkstra, A* euclidiano e A* com landmarks.
+ */
+void testLandmarks(Graph<Node>& graph, unsigned landmarks, unsigned queries, int seed)
+{
+	cout << "-------- ALT landmarks --------" << endl;
+	unsigned cores = max(1u, thread::hardware_concurrency());
+
+	mt19937 g(seed);
+	uniform_int_distribution<int> pick(0, graph.getNumVertex() - 1);
+	vector<pair<Node, Node>> pairs;
+	while (pairs.size() < queries)
+	{
+		Node s = graph.getVertex(pick(g))->getInfo();
+		Node t = graph.getVertex(pick(g))->getInfo();
+		graph.dijkstraShortestPath(s);
+		if (graph.findVertex(t)->getDist() != INF)
+			pairs.push_back({ s, t });
+	}
+	CoordinateStore coords = coordinatesOf(graph);
+	vector<double> toTarget(coords.size());
+
+	for (auto strategy : { Landmarks<Node>::FARTHEST, Landmarks<Node>::AVOID })
+	{
+		string name = (strategy == Landmarks<Node>::FARTHEST) ? "farthest" : "avoid";
+
+		auto t0 = chrono::steady_clock::now();
+		Landmarks<Node> serial(graph, landmarks, strategy, 1, seed);
+		auto t1 = chrono::steady_clock::now();
+		Landmarks<Node> alt(graph, landmarks, strategy, cores, seed);
+		auto t2 = chrono::steady_clock::now();
+
+		long long serialUs = chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+		long long parallelUs = chrono::duration_cast<chrono::microseconds>(t2 - t1).count();
+		cout << name << " | " << alt.getNumLandmarks() << " landmarks | " << alt.memoryUsage() / 1024 << " KiB"
+			<< " | preprocessing: " << serialUs / 1000.0 << " ms (1 thread), " << parallelUs / 1000.0 << " ms ("
+			<< cores << " threads) | efficiency: " << serialUs / (double)max(parallelUs * cores, 1LL) << endl;
+
+		long long dijkstraUs = 0, euclidUs = 0, altUs = 0;
+		unsigned mismatches = 0;
+		for (auto& p : pairs)
+		{
+			Vertex<Node>* target = graph.findVertex(p.second);
+			Node t = p.second;
+
+			auto s0 = chrono::steady_clock::now();
+			{
+				StatsScope scope(graph.getStats(), searchStats, "Dijkstra");
+				graph.dijkstraShortestPath(p.first);
+			}
+			double expected = target->getDist();
+			auto s1 = chrono::steady_clock::now();
+			{
+				StatsScope scope(graph.getStats(), searchStats, "A* euclidean");
+				coords.distances(t.x, t.y, toTarget.data());
+				graph.aStarShortestPath(p.first, t, [&toTarget](const Vertex<Node>* v) {
+					return toTarget[v->getIndex()];
+				});
+			}
+			double euclid = target->getDist();
+			auto s2 = chrono::steady_clock::now();
+			{
+				StatsScope scope(graph.getStats(), searchStats, "A* landmarks (" + name + ")");
+				alt.shortestPath(p.first, t);
+			}
+			auto s3 = chrono::steady_clock::now();
+
+			if (fabs(euclid - expected) > 1e-6 * expected || fabs(target->getDist() - expected) > 1e-6 * expected)
+				mismatches++;
+			dijkstraUs += chrono::duration_cast<chrono::microseconds>(s1 - s0).count();
+			euclidUs += chrono::duration_cast<chrono::microseconds>(s2 - s1).count();
+			altUs += chrono::duration_cast<chrono::microseconds>(s3 - s2).count();
+		}
+		cout << name << " | " << queries << " queries | Dijkstra " << dijkstraUs / (double)queries
+			<< " us | A* euclidean " << euclidUs / (double)queries << " us | ALT " << altUs / (double)queries
+			<< " us | mismatches: " << mismatches << endl;
+	}
+	printStatsReport(cout, searchStats);
+}
+
+/**
+ * Distâncias de vários centros (CENTRO_APOIO + aleatórios) a todos os nós:
+ * Dijkstra em série vs hubDistances com 1 thread e com todas, verificação,
+ * e gravação/leitura (mmap) da matriz em "filePath".
+ */
+void testHubDistances(Graph<Node>& graph, unsigned hubCount, int seed, const string& filePath)
+{
+	cout << "-------- Hub distance matrix --------" << endl;
+	unsigned cores = max(1u, thread::hardware_concurrency());
+
+	vector<Node> hubs = { graph.findVertex( CENTRO_APOIO )->getInfo() };
+	mt19937 g(seed);
+	uniform_int_distribution<int> pick(0, graph.getNumVertex() - 1);
+	while (hubs.size() < hubCount)
+		hubs.push_back(graph.getVertex(pick(g))->getInfo());
+
+	// Como até aqui: um dijkstraShortestPath por centro
+	auto t0 = chrono::steady_clock::now();
+	for (auto& h : hubs)
+		graph.dijkstraShortestPath(h);
+	auto t1 = chrono::steady_clock::now();
+	DistanceMatrix serial = hubDistances(graph, hubs, 1);
+	auto t2 = chrono::steady_clock::now();
+	DistanceMatrix matrix = hubDistances(graph, hubs, cores);
+	auto t3 = chrono::steady_clock::now();
+
+	long long loopUs = chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+	long long serialUs = chrono::duration_cast<chrono::microseconds>(t2 - t1).count();
+	long long parallelUs = chrono::duration_cast<chrono::microseconds>(t3 - t2).count();
+	cout << hubs.size() << " hubs x " << graph.getNumVertex() << " vertices | "
+		<< (size_t)hubs.size() * graph.getNumVertex() * sizeof(float) / 1024 << " KiB" << endl;
+	cout << "dijkstraShortestPath loop: " << loopUs / 1000.0 << " ms | hubDistances 1 thread: " << serialUs / 1000.0
+		<< " ms | " << cores << " threads: " << parallelUs / 1000.0 << " ms | efficiency: "
+		<< serialUs / (double)max(parallelUs * cores, 1LL) << endl;
+
+	unsigned mismatches = 0;
+	for (unsigned h = 0; h < hubs.size(); h++)
+	{
+		graph.dijkstraShortestPath(hubs[h]);
+		for (int v = 0; v < graph.getNumVertex(); v++)
+		{
+			double d = graph.getVertex(v)->getDist();
+			float m = matrix.at(h, v);
+			if ((d == INF) != (m == DistanceMatrix::UNREACHABLE) || (d != INF && fabs(d - m) > 1e-3 * max(1.0, d)))
+				mismatches++;
+		}
+	}
+	cout << "Mismatches vs dijkstraShortestPath: " << mismatches << endl;
+
+	if (!matrix.save(filePath))
+	{
+		cerr << "Unable to write " << filePath << endl;
+		return;
+	}
+	auto t4 = chrono::steady_clock::now();
+	DistanceMatrix loaded;
+	bool ok = loaded.load(filePath, graphFingerprint(graph));
+	auto t5 = chrono::steady_clock::now();
+	bool same = ok && loaded.getNumHubs() == matrix.getNumHubs();
+	for (unsigned h = 0; same && h < hubs.size(); h++)
+		same = loaded.getHubID(h) == hubs[h].id && equal(matrix.row(h), matrix.row(h) + graph.getNumVertex(), loaded.row(h));
+	cout << "Reload " << (loaded.isMapped() ? "(mmap)" : "(read)") << ": " << chrono::duration_cast<chrono::microseconds>(t5 - t4).count()
+		<< " us | " << (same ? "identical" : "FAILED") << " | centro row: " << loaded.findHub(CENTRO_APOIO) << endl;
+}
+
+/**
+ * Kernels em lote do CoordinateStore contra o ciclo escalar de sempre
+ * (um par de cada vez): distâncias um-para-muitos, vizinho mais próximo e pesos das arestas.
+ */
+void testCoordinateKernels(Graph<Node>& graph, unsigned queries, int seed)
+{
+	cout << "-------- Coordinate kernels (" << CoordinateStore::kernelName() << ") --------" << endl;
+	CoordinateStore coords = coordinatesOf(graph);
+	unsigned n = coords.size();
+
+	mt19937 g(seed);
+	uniform_real_distribution<double> px(coords.x(0) - 1000, coords.x(0) + 1000), py(coords.y(0) - 1000, coords.y(0) + 1000);
+	vector<pair<double, double>> points(queries);
+	for (auto& p : points)
+		p = { px(g), py(g) };
+
+	// Um-para-muitos
+	vector<double> scalar(n), batch(n);
+	double maxDiff = 0;
+	long long scalarUs = 0, batchUs = 0;
+	for (auto& p : points)
+	{
+		auto t0 = chrono::steady_clock::now();
+		for (unsigned i = 0; i < n; i++)
+		{
+			Node v = graph.getVertex(i)->getInfo();
+			scalar[i] = sqrt( pow(v.x - p.first, 2) + pow(v.y - p.second, 2) );
+		}
+		auto t1 = chrono::steady_clock::now();
+		coords.distances(p.first, p.second, batch.data());
+		auto t2 = chrono::steady_clock::now();
+		scalarUs += chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+		batchUs += chrono::duration_cast<chrono::microseconds>(t2 - t1).count();
+		for (unsigned i = 0; i < n; i++)
+			maxDiff = max(maxDiff, fabs(scalar[i] - batch[i]));
+	}
+	cout << "One-to-many (" << queries << " x " << n << "): scalar " << scalarUs / 1000.0 << " ms | batch "
+		<< batchUs / 1000.0 << " ms | speedup " << scalarUs / (double)max(batchUs, 1LL) << " | max diff " << maxDiff << endl;
+
+	// Vizinho mais próximo
+	unsigned mismatches = 0;
+	scalarUs = batchUs = 0;
+	for (auto& p : points)
+	{
+		auto t0 = chrono::steady_clock::now();
+		double dst = INF;
+		unsigned closest = n;
+		for (unsigned i = 0; i < n; i++)
+		{
+			Node v = graph.getVertex(i)->getInfo();
+			double temp = sqrt( pow(v.x - p.first, 2) + pow(v.y - p.second, 2) );
+			if (temp < dst)
+			{
+				dst = temp;
+				closest = i;
+			}
+		}
+		auto t1 = chrono::steady_clock::now();
+		double dst2;
+		size_t found = coords.argmin(p.first, p.second, n, dst2);
+		auto t2 = chrono::steady_clock::now();
+		scalarUs += chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+		batchUs += chrono::duration_cast<chrono::microseconds>(t2 - t1).count();
+		if (found != closest)
+			mismatches++;
+	}
+	cout << "Argmin (" << queries << " x " << n << "): scalar " << scalarUs / 1000.0 << " ms | batch "
+		<< batchUs / 1000.0 << " ms | speedup " << scalarUs / (double)max(batchUs, 1LL) << " | mismatches " << mismatches << endl;
+
+	// Pesos das arestas
+	vector<uint32_t> from, to;
+	vector<double> weights;
+	for (unsigned i = 0; i < n; i++)
+		for (auto& e : graph.getVertex(i)->getOutgoing())
+		{
+			from.push_back(i);
+			to.push_back(e.getDest());
+			weights.push_back(e.getWeight());
+		}
+	vector<double> scalarW(from.size()), batchW(from.size());
+	auto t0 = chrono::steady_clock::now();
+	for (unsigned rep = 0; rep < queries; rep++)
+		for (size_t k = 0; k < from.size(); k++)
+		{
+			Node n1 = graph.getVertex(from[k])->getInfo();
+			Node n2 = graph.getVertex(to[k])->getInfo();
+			double dx = n2.x - n1.x;
+			double dy = n2.y - n1.y;
+			scalarW[k] = sqrt(dx * dx + dy * dy);
+		}
+	auto t1 = chrono::steady_clock::now();
+	for (unsigned rep = 0; rep < queries; rep++)
+		coords.pairDistances(from.data(), to.data(), from.size(), batchW.data());
+	auto t2 = chrono::steady_clock::now();
+	scalarUs = chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+	batchUs = chrono::duration_cast<chrono::microseconds>(t2 - t1).count();
+	maxDiff = 0;
+	for (size_t k = 0; k < from.size(); k++)
+		maxDiff = max(maxDiff, max(fabs(scalarW[k] - batchW[k]), fabs(weights[k] - batchW[k])));
+	cout << "Edge weights (" << queries << " x " << from.size() << "): scalar " << scalarUs / 1000.0 << " ms | batch "
+		<< batchUs / 1000.0 << " ms | speedup " << scalarUs / (double)max(batchUs, 1LL) << " | max diff " << maxDiff << endl;
+}
+
 int main(int argc, char* argv[])
 {
 	Graph<Node> myGraph;
@@ -700,10 +2001,11 @@ int main(int argc, char* argv[])
 	int edgeCount;
 	unsigned packageAmount;
 
-	if(argc == 5)
+	if(argc == 5 || argc == 6)
 	{
 		seed = atoi(argv[1]);
 		packageAmount = atoi(argv[2]);
+		myGraph.reserve(readElementCount(string(argv[3])), 2 * readElementCount(string(argv[4])));
 		if( (nodeCount = nodeFileToGraph(myGraph, string(argv[3]))) == -1 )
 		{
 			std::cerr << "Failed to read node file: " << string(argv[2]) << endl;
@@ -718,7 +2020,7 @@ int main(int argc, char* argv[])
 	}
 	else
 	{
-		std::cerr << "Wrong usage: [seed int] [package count uint] [node file path] [edge file path]" << endl;
+		std::cerr << "Wrong usage: [seed int] [package count uint] [node file path] [edge file path] [vertex order file|hilbert|bfs]" << endl;
 		return -1;
 	}
 
@@ -728,6 +2030,13 @@ int main(int argc, char* argv[])
 	// Verificar nós inatingíveis/sem saída -> Tentar ligá-los entre si
 	checkInaccessibleNodes(myGraph, edgeCount, false);
 
+	// Reordenar vértices para localidade em memória (opcional)
+	if (argc == 6 && !renumberVertices(myGraph, string(argv[5])))
+	{
+		std::cerr << "Unknown vertex order: " << string(argv[5]) << endl;
+		return -1;
+	}
+
 	cout << "ENTER to continue..." << endl << endl;
 	getchar();
 
@@ -736,11 +2045,54 @@ int main(int argc, char* argv[])
 
 	
 	// AVERAGE ROUTE TIMES WITH RANDOM PACKAGES
-	//testAverageRouteTimeWithRandomPackages(myGraph, deliveryRoute, randomPackages, packageAmount, seed, edgeCount, true);
+	//testAverageRouteTimeWithRandomPackages(myGraph, deliveryRoute, randomPackages, packageAmount, 10, seed, edgeCount, true);
+
+	// // ROUTE EXPERIMENTS (SEEDS X PACKAGES X ALGORITHM, PARALLEL, CSV)
+	//testRouteExperiments(myGraph, 8, seed, edgeCount, "experiments.csv");
 
 	// // AVERAGE ROUTE TIMES
 	//testAverageRouteTime(myGraph, deliveryRoute, randomPackages, packageAmount, seed, edgeCount);
 
+	// // GRAPHVIEWER PIPELINE (LOCAL STUB SERVER)
+	//testViewerPipeline(myGraph);
+
+	// // CONNECTION READER (1M "ok" LINES FROM A LOCAL SERVER)
+	//testConnectionReader(1000000);
+
+	// // SINGLE ROUTE -> SVG (NO JAVA VIEWER)
+	//testSingleRouteAndRender(myGraph, deliveryRoute, randomPackages, packageAmount, seed, edgeCount, "route.svg");
+	//testSvgRenderLarge("grid.svg");
+
+	// // VIEWER SCENE (VIEWPORT, CHAIN COLLAPSE, DELTA UPDATES)
+	//testViewerScene(myGraph, deliveryRoute, randomPackages, packageAmount, seed, edgeCount, "scene.svg");
+
+	// // DEGREE-2 CHAIN COMPRESSION
+	//testChainCompression(myGraph, packageAmount, seed);
+
+	// // ALT LANDMARKS (A* WITH LANDMARK LOWER BOUNDS)
+	//testLandmarks(myGraph, 16, packageAmount, seed);
+
+	// // HUB DISTANCE MATRIX (PARALLEL, MMAP FILE)
+	//testHubDistances(myGraph, 8, seed, "hubs.bin");
+
+	// // COORDINATE KERNELS (SOA / SIMD VS SCALAR)
+	//testCoordinateKernels(myGraph, 1000, seed);
+
+	// // VERTEX ORDERS (CACHE LOCALITY)
+	//testVertexOrders(myGraph);
+
+	// // EDGE LAYOUT (MEMORY PER EDGE / DIJKSTRA TIME)
+	//testEdgeLayout(myGraph);
+
+	// // GRAPH LOAD TIME / MEMORY (ALLOCATION POLICIES)
+	//testGraphLoad(string(argv[3]), string(argv[4]));
+
+	// // RUSH HOUR ROUTES (TIME-DEPENDENT COSTS)
+	//testRushHourRoutes(myGraph, deliveryRoute, randomPackages, packageAmount, seed, edgeCount);
+
+	// // ROAD CLOSURES (DYNAMIC SHORTEST PATHS)
+	//testRoadClosures(myGraph, packageAmount, seed);
+
 	// // SINGLE ROUTE + DRAWING
 	testSingleRouteAndDraw(myGraph, deliveryRoute, randomPackages, packageAmount, seed, edgeCount);
 